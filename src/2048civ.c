@@ -15,13 +15,30 @@
 #include <string.h>
 
 #include "sprite.h"
+#include "ai.h"
+#include "atlas.h"
 /* Terrain type and path API */
 #include "path.h"
 /* Include runtime config and runtime-sized terrain buffer */
 #include "config.h"
 #include "perlin.h"
 #include "job.h"
+#include "combat.h"
+#include "fog.h"
+#include "fov.h"
 #include "hex_utils.h"
+#include "intern.h"
+#include "dirty.h"
+#include "mapimage.h"
+#include "spritebatch.h"
+#include "textcache.h"
+#include "textwrap.h"
+#include "frameclock.h"
+#include "timing.h"
+#include "profiler.h"
+#include "rng.h"
+#include "spatial.h"
+#include "world.h"
 
 #define WINDOW_WIDTH 1000
 #define WINDOW_HEIGHT 700
@@ -33,19 +50,17 @@ int g_window_height = WINDOW_HEIGHT;
 int g_main_width = WINDOW_WIDTH * 4 / 5;
 #define HEX_RADIUS 40 // 默认六边形半径
 int current_radius = HEX_RADIUS;
-const int MIN_RADIUS = 8;
+const int MIN_RADIUS = 2;
+/* at or below this radius terrain is drawn from the downsampled LOD image */
+#define LOD_MAX_RADIUS 7
+/* upper bound for either side of the LOD texture */
+#define LOD_MAX_TEXTURE_DIM 4096
 const int MAX_RADIUS = 120;
 /* minimum radius at which to show per-cell coordinates when enabled */
 #define COORDS_SHOW_MIN_RADIUS 16
 /* pixels threshold to treat mouse press+release as a click (not a drag) */
 #define CLICK_DRAG_THRESHOLD 5
 
-/* MAP size is provided by config at runtime */
-int g_map_rows = 0;
-int g_map_cols = 0;
-Terrain* g_terrain_map = NULL; /* flattened [row*cols + col] */
-#define TERRAIN_AT(r,c) (g_terrain_map[(r)*g_map_cols + (c)])
-
 // 当前选中的单元格
 int selected_row = -1;
 int selected_col = -1;
@@ -58,10 +73,24 @@ int highlight_neighbors_enabled = 1; /* default enabled */
 int hover_row = -1, hover_col = -1;
 // show cell coordinates toggle
 int show_cell_coords_enabled = 1; /* default enabled */
+// frame profiler HUD toggle (info panel)
+int show_profiler_enabled = 0;
+/* interval between profiler HUD refreshes (ms) */
+#define PROFILER_HUD_MS 500
+/* fixed update step for movement/animation and target frame time without vsync (ms) */
+#define UPDATE_STEP_MS 10.0
+#define TARGET_FRAME_MS (1000.0 / 60.0)
+/* longest sleep while idle; bounds latency of timers that are not events */
+#define IDLE_WAIT_MS 1000
 // TTF font and info texture
 TTF_Font* g_font = NULL;
-SDL_Texture* g_info_tex = NULL;
+/* Info panel text, one entry per line; each line is drawn from the text cache */
+#define INFO_MAX_LINES 64
+char* g_info_lines[INFO_MAX_LINES];
+int g_info_nlines = 0;
+int g_info_spacing = 0; /* extra pixels between lines */
 int g_info_w = 0, g_info_h = 0;
+GlyphCache g_glyphs; /* advances of g_font, for wrapping */
 // Camera / panning
 int cam_x = 0;
 int cam_y = 0;
@@ -70,6 +99,8 @@ int drag_start_x = 0;
 int drag_start_y = 0;
 int cam_start_x = 0;
 int cam_start_y = 0;
+/* left button went down on the minimap: motion keeps recentering the view */
+int minimap_dragging = 0;
 
 // Map bounds (world coords, without cam)
 int map_min_x = 0, map_max_x = 0, map_min_y = 0, map_max_y = 0;
@@ -101,32 +132,58 @@ int attack_mode = ATTACK_MODE_NONE; // 当前攻击模式
 int attack_target_row = -1, attack_target_col = -1; // 攻击目标位置
 int attack_range = 1; // 默认攻击范围
 
+/* Demo units and their atlas frames (set up in main) */
+Sprite *player = NULL;
+Sprite *enemy = NULL;
+#define PLAYER_FACTION 0
+#define ENEMY_FACTION 1
+/* enemy turn, planned a slice per frame after each player action */
+static AiPlanner s_enemy_ai;
+SDL_Texture *atlas_tex = NULL;
+#define ATLAS_DESC_PATH "res/drawable/dungeon"
+int player_run_frame = 0; /* current frame of the player's run animation */
+
+/* movement state: when a path (path_nodes) is computed and an endpoint selected,
+    we will animate the player along the path at a configurable ms-per-tile speed. */
+int moving = 0;
+int move_index = 0; /* next index in path_nodes to move to (0 is start) */
+/* interpolation state for smooth movement between hex cells */
+int move_from_r = -1, move_from_c = -1;
+int move_to_r = -1, move_to_c = -1;
+float move_progress = 0.0f; /* 0.0 .. 1.0 */
+
+/* Cached layers for partial redraws of the map view: terrain for the current
+ * camera, and the composed scene that is patched only inside dirty regions. */
+SDL_Texture* g_terrain_tex = NULL;
+SDL_Texture* g_scene_tex = NULL;
+int g_terrain_cache_valid = 0;
+
+/* Level-of-detail terrain image (see mapimage.h), refilled only when
+ * g_lod_valid is cleared, i.e. after the terrain changes. */
+SDL_Texture* g_lod_tex = NULL;
+int g_lod_w = 0, g_lod_h = 0, g_lod_step = 1;
+int g_lod_valid = 0;
+
+/* Minimap in the info panel: a small image of the whole map built the same
+ * way, filled once per terrain change; markers are drawn on top each frame. */
+#define MINIMAP_MAX_HEIGHT_FRAC 0.4
+SDL_Texture* g_minimap_tex = NULL;
+int g_minimap_w = 0, g_minimap_h = 0, g_minimap_step = 1;
+int g_minimap_valid = 0;
+
 
 void compute_hex_points(int cx, int cy, int radius, SDL_Point* pts);
 
 static inline int idx_of(int r, int c) { return r * g_map_cols + c; }
 
-// neighbor offsets for odd-q vertical layout (cols offset)
-int get_neighbors(int r, int c, int *out_r, int *out_c) {
-    const int even_d[6][2] = {{-1,-1},{-1,0},{-1,1},{0,1},{1,0},{0,-1}};
-    const int odd_d[6][2]  = {{0,-1},{-1,0},{0,1},{1,1},{1,0},{1,-1}};
-    int count = 0;
-    const int (*d)[2] = (c % 2 == 0) ? even_d : odd_d;
-    for (int i = 0; i < 6; ++i) {
-        int nr = r + d[i][0];
-        int nc = c + d[i][1];
-        if (nr >= 0 && nr < g_map_rows && nc >= 0 && nc < g_map_cols) {
-            out_r[count] = nr; out_c[count] = nc; count++;
-        }
-    }
-    return count;
-}
-
 // Compute map pixel bounds (including hex vertices) in world coords (no cam offset)
 void compute_map_bounds(int radius) {
     int first = 1;
+    /* only border cells can hold the extreme vertices */
     for (int row = 0; row < g_map_rows; row++) {
-        for (int col = 0; col < g_map_cols; col++) {
+        int col_step = (row == 0 || row == g_map_rows - 1) ? 1 : g_map_cols - 1;
+        if (col_step < 1) col_step = 1;
+        for (int col = 0; col < g_map_cols; col += col_step) {
             int cx = col * (radius * 3 / 2) + radius + 50;
             int cy = row * (radius * sqrt(3)) + radius + 50;
             if (col % 2) cy += radius * sqrt(3) / 2;
@@ -171,11 +228,14 @@ void clamp_camera() {
 
 // 计算六边形中心点坐标
 void hex_center(int row, int col, int radius, int* x, int* y) {
-    *x = col * (radius * 3 / 2) + radius + 50 + cam_x;
-    *y = row * (radius * sqrt(3)) + radius + 50 + cam_y;
-    if (col % 2) {
-        *y += radius * sqrt(3) / 2;
-    }
+    hex_layout_center(row, col, radius, x, y);
+    *x += 50 + cam_x;
+    *y += 50 + cam_y;
+}
+
+// 屏幕坐标对应的单元格（不在地图上返回0）
+int cell_at_screen(int mx, int my, int* row, int* col) {
+    return hex_pick(mx - 50 - cam_x, my - 50 - cam_y, current_radius, g_map_rows, g_map_cols, row, col);
 }
 
 // 取得地形对应的颜色
@@ -257,127 +317,85 @@ int get_info_panel_width() {
     return g_window_width - g_main_width - 20; // 减去边距
 }
 
-// 将文本按指定宽度自动换行
-char* wrap_text(const char* text, int max_width) {
-    if (!text || !g_font) return NULL;
-
-    char* result = malloc(strlen(text) * 2 + 1); // 预留足够空间
-    if (!result) return NULL;
-
-    char* current_pos = result;
-    const char* start = text;
-    const char* end = text;
-
-    while (*end) {
-        // 找到下一个换行符或字符串结束
-        const char* line_end = strchr(end, '\n');
-        if (!line_end) line_end = text + strlen(text);
-
-        // 处理这一行
-        const char* line_start = end;
-        const char* word_start = line_start;
-        const char* word_end = line_start;
-
-        while (word_start < line_end) {
-            // 找到下一个单词边界
-            while (*word_end && *word_end != ' ' && *word_end != '\t' && word_end < line_end) {
-                word_end++;
-            }
-
-            // 计算当前行的宽度
-            char temp_line[256];
-            int line_len = word_end - line_start;
-            if (line_len >= sizeof(temp_line)) line_len = sizeof(temp_line) - 1;
-            strncpy(temp_line, line_start, line_len);
-            temp_line[line_len] = '\0';
-
-            int line_width = 0;
-            TTF_SizeUTF8(g_font, temp_line, &line_width, NULL);
-
-            // 如果超出宽度，换行
-            if (line_width > max_width && word_start > line_start) {
-                // 复制当前行（不包括最后一个单词）
-                int copy_len = word_start - line_start - 1;
-                if (copy_len > 0) {
-                    strncpy(current_pos, line_start, copy_len);
-                    current_pos += copy_len;
-                }
-                *current_pos++ = '\n';
-                line_start = word_start;
-            }
-
-            // 移动到下一个单词
-            word_start = word_end;
-            while (*word_start && (*word_start == ' ' || *word_start == '\t') && word_start < line_end) {
-                word_start++;
-            }
-            word_end = word_start;
-        }
-
-        // 复制剩余的行内容
-        int copy_len = line_end - line_start;
-        if (copy_len > 0) {
-            strncpy(current_pos, line_start, copy_len);
-            current_pos += copy_len;
-        }
+/* GlyphAdvanceFn for a TTF_Font */
+static int font_glyph_advance(void* user, uint32_t cp) {
+    TTF_Font* font = user;
+    int adv = 0;
+    if (cp <= 0xFFFF && TTF_GlyphMetrics(font, (Uint16)cp, NULL, NULL, NULL, NULL, &adv) == 0) return adv;
+    /* outside the BMP (or missing glyph): assume a square cell */
+    return TTF_FontHeight(font);
+}
 
-        // 处理换行符
-        if (*line_end == '\n') {
-            *current_pos++ = '\n';
-            end = line_end + 1;
-        } else {
-            end = line_end;
+/* Replace the info panel text with `nlines` lines. Line textures come from the
+ * text cache, so only lines never shown before get rasterized. */
+static int set_info_text(SDL_Renderer* renderer, const char** lines, int nlines, int spacing) {
+    if (!g_font) return 0;
+    if (nlines > INFO_MAX_LINES) nlines = INFO_MAX_LINES;
+    int max_w = 0, total_h = 0;
+    for (int i = 0; i < nlines; ++i) {
+        const char* line = lines[i] ? lines[i] : "";
+        if (i >= g_info_nlines || strcmp(g_info_lines[i], line) != 0) {
+            char* copy = malloc(strlen(line) + 1);
+            if (!copy) return 0;
+            strcpy(copy, line);
+            if (i < g_info_nlines) free(g_info_lines[i]);
+            g_info_lines[i] = copy;
+            if (i >= g_info_nlines) g_info_nlines = i + 1;
         }
+        SDL_Color col = {255,255,255,255};
+        int w = 0, h = 0;
+        textcache_get(renderer, g_font, line, col, &w, &h);
+        if (h == 0) h = TTF_FontHeight(g_font);
+        if (w > max_w) max_w = w;
+        total_h += h + (i > 0 ? spacing : 0);
     }
+    for (int i = nlines; i < g_info_nlines; ++i) free(g_info_lines[i]);
+    g_info_nlines = nlines;
+    g_info_spacing = spacing;
+    g_info_w = max_w;
+    g_info_h = total_h;
+    return 1;
+}
 
-    *current_pos = '\0';
-    return result;
+/* Clear the info panel */
+void clear_info_text(void) {
+    for (int i = 0; i < g_info_nlines; ++i) free(g_info_lines[i]);
+    g_info_nlines = 0;
+    g_info_w = g_info_h = 0;
 }
 
-// Create texture from text with automatic word wrapping (frees previous texture if non-NULL)
+// Set info panel text with automatic word wrapping (replaces the previous text)
 int create_text_texture(SDL_Renderer* renderer, const char* text) {
     if (!g_font) return 0;
-    if (g_info_tex) { SDL_DestroyTexture(g_info_tex); g_info_tex = NULL; }
 
     // 计算可用宽度
     int max_width = get_info_panel_width();
 
     // 自动换行
-    char* wrapped_text = wrap_text(text, max_width);
-    if (!wrapped_text) return 0;
-
-    SDL_Color col = {255,255,255,255};
-    SDL_Surface* surf = TTF_RenderUTF8_Blended_Wrapped(g_font, wrapped_text, col, max_width);
-
-    free(wrapped_text);
+    TextSpan spans[INFO_MAX_LINES];
+    int nlines = textwrap(&g_glyphs, text, max_width, spans, INFO_MAX_LINES);
+    if (nlines > INFO_MAX_LINES) nlines = INFO_MAX_LINES;
+
+    /* copy the spans out as NUL-terminated lines */
+    char* buf = malloc(strlen(text) + nlines + 1);
+    if (!buf) return 0;
+    const char* lines[INFO_MAX_LINES];
+    char* out = buf;
+    for (int i = 0; i < nlines; ++i) {
+        memcpy(out, text + spans[i].start, spans[i].len);
+        lines[i] = out;
+        out += spans[i].len;
+        *out++ = '\0';
+    }
 
-    if (!surf) return 0;
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
-    if (!tex) { SDL_FreeSurface(surf); return 0; }
-    g_info_tex = tex;
-    g_info_w = surf->w;
-    g_info_h = surf->h;
+    int ok = set_info_text(renderer, lines, nlines, 0);
+    free(buf);
 
     // 确保宽度不超过面板宽度
     if (g_info_w > max_width) {
         g_info_w = max_width;
     }
-
-    SDL_FreeSurface(surf);
-    return 1;
-}
-
-// Create a temporary texture from text and return it (caller must destroy)
-SDL_Texture* create_text_texture_local(SDL_Renderer* renderer, const char* text, int *out_w, int *out_h) {
-    if (!g_font) return NULL;
-    SDL_Color col = {255,255,255,255};
-    SDL_Surface* surf = TTF_RenderUTF8_Blended(g_font, text, col);
-    if (!surf) return NULL;
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
-    if (tex && out_w) *out_w = surf->w;
-    if (tex && out_h) *out_h = surf->h;
-    SDL_FreeSurface(surf);
-    return tex;
+    return ok;
 }
 
 // 绘制并填充六边形
@@ -396,48 +414,10 @@ void draw_hex_terrain(SDL_Renderer* renderer, int cx, int cy, int radius, Terrai
     SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
 }
 
-/* Create and set a multi-line info texture from an array of lines. */
+/* Set the info panel to an array of lines. */
 int set_info_lines(SDL_Renderer* renderer, const char** lines, int nlines) {
     if (!g_font || nlines <= 0) return 0;
-    SDL_Surface** line_surfs = malloc(sizeof(SDL_Surface*) * nlines);
-    if (!line_surfs) return 0;
-    int max_w = 0; int total_h = 0; int spacing = 4;
-    for (int i = 0; i < nlines; ++i) {
-        SDL_Color col = {255,255,255,255};
-        line_surfs[i] = TTF_RenderUTF8_Blended(g_font, lines[i] ? lines[i] : "", col);
-        if (!line_surfs[i]) {
-            for (int j = 0; j < i; ++j) SDL_FreeSurface(line_surfs[j]);
-            free(line_surfs);
-            return 0;
-        }
-        if (line_surfs[i]->w > max_w) max_w = line_surfs[i]->w;
-        total_h += line_surfs[i]->h + (i > 0 ? spacing : 0);
-    }
-
-    SDL_Surface* dest = SDL_CreateRGBSurfaceWithFormat(0, max_w, total_h, 32, SDL_PIXELFORMAT_RGBA32);
-    if (!dest) {
-        for (int i = 0; i < nlines; ++i) SDL_FreeSurface(line_surfs[i]);
-        free(line_surfs);
-        return 0;
-    }
-    SDL_FillRect(dest, NULL, SDL_MapRGBA(dest->format, 0,0,0,0));
-
-    int y = 0;
-    for (int i = 0; i < nlines; ++i) {
-        SDL_Rect dst = {0, y, line_surfs[i]->w, line_surfs[i]->h};
-        SDL_BlitSurface(line_surfs[i], NULL, dest, &dst);
-        y += line_surfs[i]->h + spacing;
-        SDL_FreeSurface(line_surfs[i]);
-    }
-    free(line_surfs);
-
-    if (g_info_tex) { SDL_DestroyTexture(g_info_tex); g_info_tex = NULL; }
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, dest);
-    if (!tex) { SDL_FreeSurface(dest); return 0; }
-    g_info_tex = tex;
-    g_info_w = dest->w; g_info_h = dest->h;
-    SDL_FreeSurface(dest);
-    return 1;
+    return set_info_text(renderer, lines, nlines, 4);
 }
 
 // 渲染玩家菜单
@@ -482,20 +462,16 @@ void render_player_menu(SDL_Renderer* renderer) {
         // 绘制选项文本
         if (g_font) {
             SDL_Color text_color = {255, 255, 255, 255};
-            SDL_Surface* text_surface = TTF_RenderUTF8_Blended(g_font, menu_options[i], text_color);
-            if (text_surface) {
-                SDL_Texture* text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-                if (text_texture) {
-                    SDL_Rect text_rect = {
-                        menu_x + 10,
-                        menu_y + i * option_height + (option_height - text_surface->h) / 2,
-                        text_surface->w,
-                        text_surface->h
-                    };
-                    SDL_RenderCopy(renderer, text_texture, NULL, &text_rect);
-                    SDL_DestroyTexture(text_texture);
-                }
-                SDL_FreeSurface(text_surface);
+            int tw = 0, th = 0;
+            SDL_Texture* text_texture = textcache_get(renderer, g_font, menu_options[i], text_color, &tw, &th);
+            if (text_texture) {
+                SDL_Rect text_rect = {
+                    menu_x + 10,
+                    menu_y + i * option_height + (option_height - th) / 2,
+                    tw,
+                    th
+                };
+                SDL_RenderCopy(renderer, text_texture, NULL, &text_rect);
             }
         }
 
@@ -520,31 +496,31 @@ void show_sprite_info(SDL_Renderer* renderer, Sprite* s) {
     snprintf(l0, sizeof(l0), "=== Character Info ===");
     snprintf(l1, sizeof(l1), "Name: %s", s->name ? s->name : "Unknown");
     snprintf(l2, sizeof(l2), "Job: %s", s->job ? s->job : "None");
-    snprintf(l3, sizeof(l3), "Level: %d", s->level);
+    snprintf(l3, sizeof(l3), "Level: %d", SPRITE_FIELD(s, level));
 
     // HP and MP with percentages
-    float hp_percent = (float)s->hp / (float)s->max_hp * 100.0f;
-    float mp_percent = (float)s->mp / (float)s->max_mp * 100.0f;
-    snprintf(l4, sizeof(l4), "HP: %d/%d (%.1f%%)", s->hp, s->max_hp, hp_percent);
-    snprintf(l5, sizeof(l5), "MP: %d/%d (%.1f%%)", s->mp, s->max_mp, mp_percent);
+    float hp_percent = (float)SPRITE_FIELD(s, hp) / (float)SPRITE_FIELD(s, max_hp) * 100.0f;
+    float mp_percent = (float)SPRITE_FIELD(s, mp) / (float)SPRITE_FIELD(s, max_mp) * 100.0f;
+    snprintf(l4, sizeof(l4), "HP: %d/%d (%.1f%%)", SPRITE_FIELD(s, hp), SPRITE_FIELD(s, max_hp), hp_percent);
+    snprintf(l5, sizeof(l5), "MP: %d/%d (%.1f%%)", SPRITE_FIELD(s, mp), SPRITE_FIELD(s, max_mp), mp_percent);
 
     // Combat attributes
-    snprintf(l6, sizeof(l6), "Attack: %d", s->attack);
-    snprintf(l7, sizeof(l7), "Defense: %d", s->defense);
-    snprintf(l8, sizeof(l8), "Speed: %d", s->speed);
+    snprintf(l6, sizeof(l6), "Attack: %d", SPRITE_FIELD(s, attack));
+    snprintf(l7, sizeof(l7), "Defense: %d", SPRITE_FIELD(s, defense));
+    snprintf(l8, sizeof(l8), "Speed: %d", SPRITE_FIELD(s, speed));
 
     // Movement attributes
-    snprintf(l9, sizeof(l9), "Move: %d", s->move);
+    snprintf(l9, sizeof(l9), "Move: %d", SPRITE_FIELD(s, move));
     snprintf(l10, sizeof(l10), "Jump: %d", s->jump);
 
     // Position information
-    snprintf(l11, sizeof(l11), "Position: (%d, %d)", s->x, s->y);
+    snprintf(l11, sizeof(l11), "Position: (%d, %d)", SPRITE_FIELD(s, x), SPRITE_FIELD(s, y));
 
     // Status information
     const char* status = "Normal";
-    if (s->hp <= 0) status = "Dead";
-    else if (s->hp < s->max_hp * 0.3) status = "Critical";
-    else if (s->hp < s->max_hp * 0.6) status = "Injured";
+    if (SPRITE_FIELD(s, hp) <= 0) status = "Dead";
+    else if (SPRITE_FIELD(s, hp) < SPRITE_FIELD(s, max_hp) * 0.3) status = "Critical";
+    else if (SPRITE_FIELD(s, hp) < SPRITE_FIELD(s, max_hp) * 0.6) status = "Injured";
     snprintf(l12, sizeof(l12), "Status: %s", status);
 
     // Equipment information (detailed display)
@@ -572,6 +548,752 @@ void show_sprite_info(SDL_Renderer* renderer, Sprite* s) {
     set_info_lines(renderer, lines, 14);
 }
 
+/* Range of rows/cols whose hexes may intersect the main view at the current camera. */
+void visible_cell_range(int* r0, int* r1, int* c0, int* c1) {
+    int radius = current_radius;
+    int step_x = radius * 3 / 2;
+    double step_y = radius * sqrt(3);
+    if (step_x < 1) step_x = 1;
+    *c0 = (int)floor((double)(-cam_x - 50 - 2 * radius) / step_x);
+    *c1 = (int)ceil((double)(g_main_width - cam_x - 50) / step_x);
+    *r0 = (int)floor((-cam_y - 50 - 2 * radius - step_y) / step_y);
+    *r1 = (int)ceil((g_window_height - cam_y - 50) / step_y);
+    if (*r0 < 0) *r0 = 0;
+    if (*c0 < 0) *c0 = 0;
+    if (*r1 > g_map_rows - 1) *r1 = g_map_rows - 1;
+    if (*c1 > g_map_cols - 1) *c1 = g_map_cols - 1;
+}
+
+/* Screen-space box covering everything drawn for a cell (hex, borders, sprite). */
+void cell_bounds(int row, int col, SDL_Rect* out) {
+    int cx, cy;
+    hex_center(row, col, current_radius, &cx, &cy);
+    int half = current_radius + 2;
+    out->x = cx - half; out->y = cy - half;
+    out->w = out->h = half * 2;
+}
+
+int cell_in_clip(int row, int col, const SDL_Rect* clip) {
+    if (!clip) return 1;
+    SDL_Rect b;
+    cell_bounds(row, col, &b);
+    return SDL_HasIntersection(&b, clip);
+}
+
+void mark_cell_dirty(int row, int col) {
+    if (row < 0 || col < 0) return;
+    SDL_Rect b;
+    cell_bounds(row, col, &b);
+    dirty_add(b.x, b.y, b.w, b.h);
+}
+
+/* hovered cell plus its neighbours (the hover highlight) */
+void mark_hover_dirty(int row, int col) {
+    if (row < 0 || col < 0) return;
+    int nbr_r[6], nbr_c[6];
+    int nc = get_neighbors(row, col, nbr_r, nbr_c);
+    for (int i = 0; i < nc; ++i) mark_cell_dirty(nbr_r[i], nbr_c[i]);
+    mark_cell_dirty(row, col);
+}
+
+/* mark the terrain images (LOD, minimap) stale; call after editing g_terrain_map */
+void lod_invalidate(void) {
+    g_lod_valid = 0;
+    g_minimap_valid = 0;
+}
+
+/* ARGB8888 pixel per terrain type for the map images */
+static void terrain_palette(Uint32 palette[TERRAIN_COUNT]) {
+    for (int t = 0; t < TERRAIN_COUNT; ++t) {
+        Uint8 r, g, b, a;
+        terrain_color((Terrain)t, &r, &g, &b, &a);
+        palette[t] = ((Uint32)a << 24) | ((Uint32)r << 16) | ((Uint32)g << 8) | b;
+    }
+}
+
+/* refill only the texels of a map image that sample cells in `span` */
+static void patch_map_image(SDL_Texture* tex, int w, int h, int step, Uint32 empty, const FogSpan* span) {
+    SDL_Rect rect;
+    mapimage_cells_rect(span->row_lo, span->row_hi, span->col_lo, span->col_hi, step, w, h,
+                        &rect.x, &rect.y, &rect.w, &rect.h);
+    if (rect.w <= 0 || rect.h <= 0) return;
+    void* pixels; int pitch;
+    if (SDL_LockTexture(tex, &rect, &pixels, &pitch) != 0) return;
+    Uint32 palette[TERRAIN_COUNT];
+    terrain_palette(palette);
+    mapimage_fill_rect(pixels, pitch / 4, rect.x, rect.y, rect.w, rect.h, step, palette, empty);
+    mapimage_apply_fog_rect(pixels, pitch / 4, rect.x, rect.y, rect.w, rect.h, step, PLAYER_FACTION, empty);
+    SDL_UnlockTexture(tex);
+}
+
+/* newly explored cells: patch the LOD image and the minimap in place
+ * (images not built yet are filled whole when first needed) */
+static void patch_map_images(const FogSpan* span) {
+    if (g_lod_tex && g_lod_valid) patch_map_image(g_lod_tex, g_lod_w, g_lod_h, g_lod_step, 0, span);
+    if (g_minimap_tex && g_minimap_valid)
+        patch_map_image(g_minimap_tex, g_minimap_w, g_minimap_h, g_minimap_step, 0xFF1E1E1Eu, span);
+}
+
+/* (re)fill the LOD streaming texture from the terrain map; returns 0 on failure */
+int ensure_lod_texture(SDL_Renderer* renderer) {
+    if (!g_lod_tex) {
+        int max_dim = LOD_MAX_TEXTURE_DIM;
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) == 0) {
+            if (info.max_texture_width > 0 && info.max_texture_width < max_dim) max_dim = info.max_texture_width;
+            if (info.max_texture_height > 0 && info.max_texture_height < max_dim) max_dim = info.max_texture_height;
+        }
+        mapimage_dims(g_map_rows, g_map_cols, max_dim, &g_lod_w, &g_lod_h, &g_lod_step);
+        g_lod_tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, g_lod_w, g_lod_h);
+        if (!g_lod_tex) return 0;
+        SDL_SetTextureBlendMode(g_lod_tex, SDL_BLENDMODE_BLEND);
+        g_lod_valid = 0;
+    }
+    if (!g_lod_valid) {
+        void* pixels; int pitch;
+        if (SDL_LockTexture(g_lod_tex, NULL, &pixels, &pitch) != 0) return 0;
+        Uint32 palette[TERRAIN_COUNT];
+        terrain_palette(palette);
+        mapimage_fill(pixels, pitch / 4, g_lod_w, g_lod_h, g_lod_step, palette, 0);
+        mapimage_apply_fog(pixels, pitch / 4, g_lod_w, g_lod_h, g_lod_step, PLAYER_FACTION, 0);
+        SDL_UnlockTexture(g_lod_tex);
+        g_lod_valid = 1;
+    }
+    return 1;
+}
+
+/* Draw the whole terrain as one stretched copy of the LOD image. A texel
+ * column spans g_lod_step hex columns and a texel row g_lod_step half-rows.
+ */
+int draw_terrain_lod(SDL_Renderer* renderer) {
+    if (!ensure_lod_texture(renderer)) return 0;
+    int r = current_radius;
+    int step_x = r * 3 / 2;
+    double half_row = r * sqrt(3) / 2;
+    double x0 = 50 + cam_x + r - step_x / 2.0;
+    double y0 = 50 + cam_y + r - half_row;
+    SDL_Rect dst = { (int)floor(x0), (int)floor(y0),
+                     (int)ceil((double)g_lod_w * g_lod_step * step_x),
+                     (int)ceil(g_lod_h * g_lod_step * half_row) };
+    SDL_RenderCopy(renderer, g_lod_tex, NULL, &dst);
+    return 1;
+}
+
+/* terrain hexes of rows r0..r1, columns c0..c1 */
+static void draw_terrain_cells(SDL_Renderer* renderer, int r0, int r1, int c0, int c1) {
+    for (int row = r0; row <= r1; row++) {
+        for (int col = c0; col <= c1; col++) {
+            /* 战争迷雾：未探索的格子不绘制，已探索但不在视野内的变暗 */
+            if (!fog_explored(PLAYER_FACTION, row, col)) continue;
+            int cx, cy;
+            hex_center(row, col, current_radius, &cx, &cy);
+            draw_hex_terrain(renderer, cx, cy, current_radius - 1, TERRAIN_AT(row,col));
+            if (!fog_visible(PLAYER_FACTION, row, col)) {
+                SDL_Point pts[6];
+                compute_hex_points(cx, cy, current_radius - 1, pts);
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 120);
+                fill_polygon(renderer, pts, 6);
+            }
+
+            if (show_cell_coords_enabled && current_radius >= COORDS_SHOW_MIN_RADIUS) {
+                char coordbuf[32];
+                snprintf(coordbuf, sizeof(coordbuf), "%d,%d", row, col);
+                int tw=0, th=0;
+                SDL_Color white = {255,255,255,255};
+                SDL_Texture* ttx = textcache_get(renderer, g_font, coordbuf, white, &tw, &th);
+                if (ttx) {
+                    SDL_SetTextureBlendMode(ttx, SDL_BLENDMODE_BLEND);
+                    SDL_Rect td = { cx - tw/2, cy - th/2, tw, th };
+                    SDL_RenderCopy(renderer, ttx, NULL, &td);
+                }
+            }
+        }
+    }
+}
+
+// 绘制地形层（仅可见单元格）
+void draw_terrain_layer(SDL_Renderer* renderer) {
+    /* zoomed far out: per-hex geometry is sub-pixel noise, use the LOD image */
+    if (current_radius <= LOD_MAX_RADIUS && draw_terrain_lod(renderer)) return;
+    int r0, r1, c0, c1;
+    visible_cell_range(&r0, &r1, &c0, &c1);
+    draw_terrain_cells(renderer, r0, r1, c0, c1);
+}
+
+/* on-screen box of the cells in `span`; returns 0 if it is off screen */
+static int fog_span_box(const FogSpan* span, SDL_Rect* out) {
+    SDL_Rect lo, hi, box;
+    /* odd columns sit half a row lower: top from an even column, bottom from an odd one */
+    cell_bounds(span->row_lo, 0, &lo);
+    cell_bounds(span->row_hi, 1, &hi);
+    box.y = lo.y;
+    box.h = hi.y + hi.h - lo.y;
+    cell_bounds(0, span->col_lo, &lo);
+    cell_bounds(0, span->col_hi, &hi);
+    box.x = lo.x;
+    box.w = hi.x + hi.w - lo.x;
+    SDL_Rect main_view = {0, 0, g_main_width, g_window_height};
+    return SDL_IntersectRect(&box, &main_view, out) == SDL_TRUE;
+}
+
+/* Redraw the cached terrain layer inside `clip` (the box of `span`) after the
+ * fog of those cells changed; the rest of g_terrain_tex is left alone. */
+static void patch_terrain_layer(SDL_Renderer* renderer, const FogSpan* span, const SDL_Rect* clip) {
+    profiler_begin(PROF_TERRAIN);
+    SDL_SetRenderTarget(renderer, g_terrain_tex);
+    SDL_RenderSetClipRect(renderer, clip);
+    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255); // 背景色
+    SDL_RenderFillRect(renderer, clip);
+    if (!(current_radius <= LOD_MAX_RADIUS && draw_terrain_lod(renderer))) {
+        /* neighbours overlap the box too, so redraw a margin around the span */
+        int r0, r1, c0, c1;
+        visible_cell_range(&r0, &r1, &c0, &c1);
+        if (r0 < span->row_lo - 2) r0 = span->row_lo - 2;
+        if (r1 > span->row_hi + 2) r1 = span->row_hi + 2;
+        if (c0 < span->col_lo - 2) c0 = span->col_lo - 2;
+        if (c1 > span->col_hi + 2) c1 = span->col_hi + 2;
+        draw_terrain_cells(renderer, r0, r1, c0, c1);
+    }
+    SDL_RenderSetClipRect(renderer, NULL);
+    profiler_end(PROF_TERRAIN);
+}
+
+/* sprite standing on (row,col), NULL if none */
+static Sprite* sprite_at(int row, int col) {
+    int k = unit_index(spatial_unit_at(row, col));
+    return k >= 0 ? g_units.owner[k] : NULL;
+}
+
+/* per-cell overlays (path cells, selection, attack targets) within `clip` (NULL = all) */
+void draw_cell_overlays(SDL_Renderer* renderer, const SDL_Rect* clip) {
+    SDL_Point pts[6];
+    int cx, cy;
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    if (in_path && path_nodes) {
+        SDL_SetRenderDrawColor(renderer, 0, 200, 200, 140);
+        for (int i = 0; i < path_len; ++i) {
+            if (!in_path[path_nodes[i]]) continue;
+            int row = path_nodes[i] / g_map_cols, col = path_nodes[i] % g_map_cols;
+            if (!cell_in_clip(row, col, clip)) continue;
+            hex_center(row, col, current_radius, &cx, &cy);
+            compute_hex_points(cx, cy, current_radius - 1, pts);
+            fill_polygon(renderer, pts, 6);
+        }
+    }
+    // 如果被选中，高亮边框
+    if (selected_row >= 0 && selected_col >= 0 && cell_in_clip(selected_row, selected_col, clip)) {
+        hex_center(selected_row, selected_col, current_radius, &cx, &cy);
+        compute_hex_points(cx, cy, current_radius - 1, pts);
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 200);
+        // 再次绘制边框以示高亮
+        SDL_RenderDrawLines(renderer, pts, 6);
+        SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
+    }
+    // 攻击模式下淡色标出攻击范围（只枚举范围内的格子）
+    if (attack_mode != ATTACK_MODE_NONE && player) {
+        int cap = hex_range_size(attack_range);
+        int *rr = malloc(sizeof(int) * 2 * cap);
+        if (rr) {
+            int *rc = rr + cap;
+            int n = hex_range(SPRITE_FIELD(player, x), SPRITE_FIELD(player, y), attack_range,
+                              g_map_rows, g_map_cols, rr, rc, cap);
+            const FovMask *view = fov_unit(player->unit);
+            SDL_SetRenderDrawColor(renderer, 255, 200, 60, 50);
+            for (int i = 0; i < n; ++i) {
+                if (!cell_in_clip(rr[i], rc[i], clip) || (view && !fov_visible(view, rr[i], rc[i]))) continue;
+                hex_center(rr[i], rc[i], current_radius, &cx, &cy);
+                compute_hex_points(cx, cy, current_radius - 1, pts);
+                fill_polygon(renderer, pts, 6);
+            }
+            free(rr);
+        }
+    }
+    // 攻击模式下高亮显示攻击范围内的敌人（空间索引只查附近的单位）
+    if (attack_mode != ATTACK_MODE_NONE && player) {
+        UnitId near[64];
+        int n = spatial_query(SPRITE_FIELD(player, x), SPRITE_FIELD(player, y), attack_range, near, 64);
+        if (n > 64) n = 64;
+        for (int i = 0; i < n; ++i) {
+            int k = unit_index(near[i]);
+            if (k < 0 || g_units.owner[k] == player || !cell_in_clip(g_units.x[k], g_units.y[k], clip)) continue;
+            hex_center(g_units.x[k], g_units.y[k], current_radius, &cx, &cy);
+            compute_hex_points(cx, cy, current_radius - 1, pts);
+            SDL_SetRenderDrawColor(renderer, 255, 50, 50, 120);
+            fill_polygon(renderer, pts, 6);
+            // 红色边框表示可攻击目标
+            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 200);
+            SDL_RenderDrawLines(renderer, pts, 6);
+            SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
+        }
+    }
+}
+
+/* Atlas source rect for a sprite: frame `frame` of its run animation when
+ * running, else the first idle frame; a 16x16 tile at the origin if unbound. */
+static void sprite_src_rect(const Sprite* s, int running, int frame, SDL_Rect* out) {
+    if (running && atlas_frame_rect(s->anim_run, frame, &out->x, &out->y, &out->w, &out->h)) return;
+    if (atlas_frame_rect(s->anim_idle, 0, &out->x, &out->y, &out->w, &out->h)) return;
+    out->x = 0; out->y = 0; out->w = 16; out->h = 16;
+}
+
+/* Destination rect that fits `src` into the hex centered at (cx,cy) */
+static void sprite_dst_rect(const SDL_Rect* src, int cx, int cy, SDL_Rect* dst) {
+    double hex_w = current_radius * 2.0;
+    double hex_h = current_radius * sqrt(3.0);
+    const double pad = 0.9; /* keep some padding inside the hex */
+    double scale_w = (hex_w * pad) / (double)src->w;
+    double scale_h = (hex_h * pad) / (double)src->h;
+    double scale = scale_w < scale_h ? scale_w : scale_h;
+    if (scale <= 0.0) scale = 1.0;
+    int dw = (int)(src->w * scale + 0.5);
+    int dh = (int)(src->h * scale + 0.5);
+    dst->x = cx - dw/2; dst->y = cy - dh/2;
+    dst->w = dw; dst->h = dh;
+}
+
+/* quads of all units, reused across frames */
+static SpriteBatch s_sprite_batch;
+
+/* Draw every unit in the store if atlas loaded. Units outside `clip` (NULL =
+ * the main view) are culled; the rest go out in one batched draw call. */
+void draw_sprites(SDL_Renderer* renderer, const SDL_Rect* clip) {
+    if (!atlas_tex) return;
+    SDL_Rect view = {0, 0, g_main_width, g_window_height};
+    sprite_batch_begin(&s_sprite_batch, atlas_tex, clip ? clip : &view);
+    for (int k = 0; k < g_units.count; ++k) {
+        const Sprite* s = g_units.owner[k];
+        if (!s) continue;
+        /* other factions' units only show on cells the player can see */
+        if (g_units.faction[k] != PLAYER_FACTION && !fog_visible(PLAYER_FACTION, g_units.x[k], g_units.y[k])) continue;
+        int running = (s == player && moving && move_from_r >= 0 && move_to_r >= 0);
+        int render_x, render_y;
+        if (running) {
+            /* the moving player is interpolated between the two cells of the current step */
+            int fx, fy, tx, ty;
+            hex_center(move_from_r, move_from_c, current_radius, &fx, &fy);
+            hex_center(move_to_r, move_to_c, current_radius, &tx, &ty);
+            float t = move_progress;
+            if (t < 0.0f) t = 0.0f; if (t > 1.0f) t = 1.0f;
+            render_x = (int)(fx + (tx - fx) * t + 0.5f);
+            render_y = (int)(fy + (ty - fy) * t + 0.5f);
+        } else {
+            hex_center(g_units.x[k], g_units.y[k], current_radius, &render_x, &render_y);
+        }
+        /* choose source rect: running frames when moving, otherwise idle */
+        SDL_Rect src, dst;
+        sprite_src_rect(s, running, player_run_frame, &src);
+        sprite_dst_rect(&src, render_x, render_y, &dst);
+        sprite_batch_add(&s_sprite_batch, &src, &dst);
+    }
+    sprite_batch_flush(&s_sprite_batch, renderer);
+}
+
+/* hover/neighbour highlight and the path polyline, drawn over sprites */
+void draw_hover_and_path(SDL_Renderer* renderer) {
+    // 绘制邻居高亮（如果启用并有悬停单元）
+    if (highlight_neighbors_enabled && hover_row >= 0 && hover_col >= 0) {
+        int nbr_r[6], nbr_c[6];
+        int nc = get_neighbors(hover_row, hover_col, nbr_r, nbr_c);
+        SDL_Point pts[6];
+        for (int i = 0; i < nc; ++i) {
+            int rr = nbr_r[i], cc = nbr_c[i];
+            int cx, cy; hex_center(rr, cc, current_radius, &cx, &cy);
+            compute_hex_points(cx, cy, current_radius - 1, pts);
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+            SDL_SetRenderDrawColor(renderer, 255, 220, 0, 120);
+            fill_polygon(renderer, pts, 6);
+            SDL_SetRenderDrawColor(renderer, 255, 220, 0, 200);
+            SDL_RenderDrawLines(renderer, pts, 6);
+            SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
+        }
+        /* highlight hovered cell differently */
+        int hcx, hcy; hex_center(hover_row, hover_col, current_radius, &hcx, &hcy);
+        compute_hex_points(hcx, hcy, current_radius - 1, pts);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 160);
+        SDL_RenderDrawLines(renderer, pts, 6);
+        SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
+    }
+
+    // 绘制路径线段（如果存在）
+    if (path_len >= 2 && path_nodes) {
+        SDL_Point *pline = malloc(sizeof(SDL_Point) * path_len);
+        if (!pline) return;
+        for (int i = 0; i < path_len; ++i) {
+            int idx = path_nodes[i];
+            int pr = idx / g_map_cols, pc = idx % g_map_cols;
+            hex_center(pr, pc, current_radius, &pline[i].x, &pline[i].y);
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 255, 80, 80, 220);
+        SDL_RenderDrawLines(renderer, pline, path_len);
+        // draw endpoints
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_Rect rs = { pline[0].x - 4, pline[0].y - 4, 8, 8 };
+        SDL_Rect re = { pline[path_len-1].x - 4, pline[path_len-1].y - 4, 8, 8 };
+        SDL_RenderFillRect(renderer, &rs);
+        SDL_RenderFillRect(renderer, &re);
+        free(pline);
+    }
+}
+
+/* Everything the scene texture shows, as of the last composition. Comparing it
+ * with the live state each frame tells which hexes need redrawing. */
+typedef struct {
+    int cam_x, cam_y, radius, coords;
+    int hover_row, hover_col, highlight;
+    int selected_row, selected_col;
+    int attack_mode;
+    int player_r, player_c, enemy_r, enemy_c;
+    int moving, from_r, from_c, to_r, to_c, run_frame;
+    float progress;
+    int *path; int path_len, path_cap;
+} SceneState;
+
+static SceneState s_drawn = { .hover_row = -1, .hover_col = -1, .selected_row = -1, .selected_col = -1,
+                              .player_r = -1, .player_c = -1, .enemy_r = -1, .enemy_c = -1,
+                              .from_r = -1, .from_c = -1, .to_r = -1, .to_c = -1 };
+
+static void mark_player_dirty(const SceneState* st) {
+    mark_cell_dirty(st->player_r, st->player_c);
+    if (st->moving) {
+        mark_cell_dirty(st->from_r, st->from_c);
+        mark_cell_dirty(st->to_r, st->to_c);
+    }
+}
+
+/* cells covered by the attack-range tint around (row,col) */
+static void mark_range_dirty(int row, int col) {
+    if (row < 0 || col < 0) return;
+    int cap = hex_range_size(attack_range);
+    int *rr = malloc(sizeof(int) * 2 * cap);
+    if (!rr) { dirty_mark_all(); return; }
+    int n = hex_range(row, col, attack_range, g_map_rows, g_map_cols, rr, rr + cap, cap);
+    for (int i = 0; i < n; ++i) mark_cell_dirty(rr[i], rr[cap + i]);
+    free(rr);
+}
+
+static void mark_path_dirty(const int* nodes, int len) {
+    for (int i = 0; i < len; ++i) mark_cell_dirty(nodes[i] / g_map_cols, nodes[i] % g_map_cols);
+}
+
+/* Diff live state against what was last composed and mark changed hexes dirty. */
+void mark_scene_changes(void) {
+    SceneState now = s_drawn;
+    now.cam_x = cam_x; now.cam_y = cam_y; now.radius = current_radius;
+    now.coords = show_cell_coords_enabled && current_radius >= COORDS_SHOW_MIN_RADIUS;
+    now.hover_row = hover_row; now.hover_col = hover_col; now.highlight = highlight_neighbors_enabled;
+    now.selected_row = selected_row; now.selected_col = selected_col;
+    now.attack_mode = attack_mode;
+    now.player_r = player ? SPRITE_FIELD(player, x) : -1; now.player_c = player ? SPRITE_FIELD(player, y) : -1;
+    now.enemy_r = enemy ? SPRITE_FIELD(enemy, x) : -1; now.enemy_c = enemy ? SPRITE_FIELD(enemy, y) : -1;
+    now.moving = moving; now.from_r = move_from_r; now.from_c = move_from_c;
+    now.to_r = move_to_r; now.to_c = move_to_c; now.run_frame = player_run_frame;
+    now.progress = move_progress;
+    int cur_len = (path_nodes && path_len > 0) ? path_len : 0;
+
+    if (now.cam_x != s_drawn.cam_x || now.cam_y != s_drawn.cam_y ||
+        now.radius != s_drawn.radius || now.coords != s_drawn.coords) {
+        g_terrain_cache_valid = 0;
+        dirty_mark_all();
+    } else {
+        if (now.hover_row != s_drawn.hover_row || now.hover_col != s_drawn.hover_col ||
+            now.highlight != s_drawn.highlight) {
+            mark_hover_dirty(s_drawn.hover_row, s_drawn.hover_col);
+            mark_hover_dirty(now.hover_row, now.hover_col);
+        }
+        if (now.selected_row != s_drawn.selected_row || now.selected_col != s_drawn.selected_col) {
+            mark_cell_dirty(s_drawn.selected_row, s_drawn.selected_col);
+            mark_cell_dirty(now.selected_row, now.selected_col);
+        }
+        int player_changed = now.player_r != s_drawn.player_r || now.player_c != s_drawn.player_c ||
+            now.moving != s_drawn.moving || now.from_r != s_drawn.from_r || now.from_c != s_drawn.from_c ||
+            now.to_r != s_drawn.to_r || now.to_c != s_drawn.to_c ||
+            now.run_frame != s_drawn.run_frame || now.progress != s_drawn.progress;
+        if (player_changed) {
+            mark_player_dirty(&s_drawn);
+            mark_player_dirty(&now);
+        }
+        /* the attack highlight depends on the enemy cell and the player's distance to it */
+        if (now.enemy_r != s_drawn.enemy_r || now.enemy_c != s_drawn.enemy_c ||
+            now.attack_mode != s_drawn.attack_mode || (player_changed && now.attack_mode != ATTACK_MODE_NONE)) {
+            mark_cell_dirty(s_drawn.enemy_r, s_drawn.enemy_c);
+            mark_cell_dirty(now.enemy_r, now.enemy_c);
+        }
+        if ((now.attack_mode != s_drawn.attack_mode || now.player_r != s_drawn.player_r ||
+             now.player_c != s_drawn.player_c) &&
+            (now.attack_mode != ATTACK_MODE_NONE || s_drawn.attack_mode != ATTACK_MODE_NONE)) {
+            if (s_drawn.attack_mode != ATTACK_MODE_NONE) mark_range_dirty(s_drawn.player_r, s_drawn.player_c);
+            if (now.attack_mode != ATTACK_MODE_NONE) mark_range_dirty(now.player_r, now.player_c);
+        }
+        if (cur_len != s_drawn.path_len ||
+            (cur_len > 0 && memcmp(path_nodes, s_drawn.path, sizeof(int) * cur_len) != 0)) {
+            mark_path_dirty(s_drawn.path, s_drawn.path_len);
+            mark_path_dirty(path_nodes, cur_len);
+        }
+    }
+
+    /* remember the path by value: path_nodes is reallocated on every change */
+    if (cur_len > now.path_cap) {
+        int* grown = realloc(now.path, sizeof(int) * cur_len);
+        if (grown) { now.path = grown; now.path_cap = cur_len; }
+        else cur_len = 0;
+    }
+    if (cur_len > 0) memcpy(now.path, path_nodes, sizeof(int) * cur_len);
+    now.path_len = cur_len;
+    s_drawn = now;
+}
+
+/* create the layer textures on first use; returns 0 if render targets are unavailable */
+int ensure_layer_textures(SDL_Renderer* renderer) {
+    if (g_terrain_tex && g_scene_tex) return 1;
+    if (!SDL_RenderTargetSupported(renderer)) return 0;
+    g_terrain_tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, g_main_width, g_window_height);
+    g_scene_tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, g_main_width, g_window_height);
+    if (!g_terrain_tex || !g_scene_tex) {
+        if (g_terrain_tex) { SDL_DestroyTexture(g_terrain_tex); g_terrain_tex = NULL; }
+        if (g_scene_tex) { SDL_DestroyTexture(g_scene_tex); g_scene_tex = NULL; }
+        return 0;
+    }
+    g_terrain_cache_valid = 0;
+    dirty_set_bounds(g_main_width, g_window_height);
+    return 1;
+}
+
+void destroy_layer_textures(void) {
+    if (g_terrain_tex) { SDL_DestroyTexture(g_terrain_tex); g_terrain_tex = NULL; }
+    if (g_scene_tex) { SDL_DestroyTexture(g_scene_tex); g_scene_tex = NULL; }
+    if (g_lod_tex) { SDL_DestroyTexture(g_lod_tex); g_lod_tex = NULL; }
+    if (g_minimap_tex) { SDL_DestroyTexture(g_minimap_tex); g_minimap_tex = NULL; }
+    free(s_drawn.path);
+    s_drawn.path = NULL; s_drawn.path_len = s_drawn.path_cap = 0;
+}
+
+/* Draw the map area. The terrain is rendered into a cached texture only when the
+ * camera changes; overlays and sprites are recomposed over it only inside dirty
+ * regions of the scene texture, which is then copied to the screen. Without
+ * render-target support everything is drawn directly each frame. */
+void render_map_view(SDL_Renderer* renderer) {
+    SDL_Rect main_view = {0, 0, g_main_width, g_window_height};
+    /* the fog is baked into the terrain layer and the map images; patch
+     * them only where it changed. The LOD image shows explored cells only. */
+    int fog = fog_update(PLAYER_FACTION);
+    if (fog) {
+        FogSpan span;
+        SDL_Rect box;
+        fog_changed_span(PLAYER_FACTION, &span);
+        if (fog & FOG_EXPLORED_CHANGED) patch_map_images(&span);
+        if (span.row_lo <= span.row_hi && fog_span_box(&span, &box)) {
+            if (g_terrain_tex && g_terrain_cache_valid &&
+                ((fog & FOG_EXPLORED_CHANGED) || current_radius > LOD_MAX_RADIUS))
+                patch_terrain_layer(renderer, &span, &box);
+            /* enemies entering or leaving the view are inside the box too */
+            dirty_add(box.x, box.y, box.w, box.h);
+        }
+    }
+    mark_scene_changes();
+
+    if (!ensure_layer_textures(renderer)) {
+        /* restrict drawing of map to main map area (left pane) */
+        SDL_RenderSetViewport(renderer, &main_view);
+        profiler_begin(PROF_TERRAIN);
+        draw_terrain_layer(renderer);
+        profiler_end(PROF_TERRAIN);
+        profiler_begin(PROF_OVERLAYS);
+        draw_cell_overlays(renderer, NULL);
+        profiler_end(PROF_OVERLAYS);
+        profiler_begin(PROF_SPRITES);
+        draw_sprites(renderer, NULL);
+        profiler_end(PROF_SPRITES);
+        profiler_begin(PROF_OVERLAYS);
+        draw_hover_and_path(renderer);
+        profiler_end(PROF_OVERLAYS);
+        dirty_clear();
+        return;
+    }
+
+    if (!g_terrain_cache_valid) {
+        profiler_begin(PROF_TERRAIN);
+        SDL_SetRenderTarget(renderer, g_terrain_tex);
+        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255); // 背景色
+        SDL_RenderClear(renderer);
+        draw_terrain_layer(renderer);
+        g_terrain_cache_valid = 1;
+        profiler_end(PROF_TERRAIN);
+    }
+
+    SDL_SetRenderTarget(renderer, g_scene_tex);
+    const DirtyRect* rects = dirty_rects();
+    for (int i = 0; i < dirty_count(); ++i) {
+        SDL_Rect clip = { rects[i].x, rects[i].y, rects[i].w, rects[i].h };
+        SDL_RenderSetClipRect(renderer, &clip);
+        profiler_begin(PROF_TERRAIN);
+        SDL_RenderCopy(renderer, g_terrain_tex, &clip, &clip);
+        profiler_end(PROF_TERRAIN);
+        profiler_begin(PROF_OVERLAYS);
+        draw_cell_overlays(renderer, &clip);
+        profiler_end(PROF_OVERLAYS);
+        profiler_begin(PROF_SPRITES);
+        draw_sprites(renderer, &clip);
+        profiler_end(PROF_SPRITES);
+        profiler_begin(PROF_OVERLAYS);
+        draw_hover_and_path(renderer);
+        profiler_end(PROF_OVERLAYS);
+    }
+    SDL_RenderSetClipRect(renderer, NULL);
+    dirty_clear();
+
+    SDL_SetRenderTarget(renderer, NULL);
+    SDL_RenderSetViewport(renderer, &main_view);
+    SDL_RenderCopy(renderer, g_scene_tex, NULL, NULL);
+}
+
+/* Box the minimap occupies at the bottom of the info panel. The image keeps
+ * the on-screen aspect of the hex layout (1.5 r per column, 0.866 r per half-row). */
+void minimap_layout(SDL_Rect* out) {
+    int box_w = get_info_panel_width() + 10;
+    int box_h = (int)(g_window_height * MINIMAP_MAX_HEIGHT_FRAC);
+    if (box_w < 1) box_w = 1;
+    if (box_h > box_w) box_h = box_w;
+    double world_w = g_map_cols * 1.5;
+    double world_h = (g_map_rows * 2 + 1) * (sqrt(3) / 2);
+    int w = box_w, h = (int)(box_w * world_h / world_w);
+    if (h > box_h) { h = box_h; w = (int)(box_h * world_w / world_h); }
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+    out->x = g_main_width + 10 + (box_w - w) / 2;
+    out->y = g_window_height - 10 - h;
+    out->w = w; out->h = h;
+}
+
+int ensure_minimap_texture(SDL_Renderer* renderer) {
+    if (!g_minimap_tex) {
+        SDL_Rect box;
+        minimap_layout(&box);
+        /* no need for more texels than screen pixels */
+        int max_dim = box.w > box.h ? box.w : box.h;
+        mapimage_dims(g_map_rows, g_map_cols, max_dim, &g_minimap_w, &g_minimap_h, &g_minimap_step);
+        g_minimap_tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, g_minimap_w, g_minimap_h);
+        if (!g_minimap_tex) return 0;
+        g_minimap_valid = 0;
+    }
+    if (!g_minimap_valid) {
+        void* pixels; int pitch;
+        if (SDL_LockTexture(g_minimap_tex, NULL, &pixels, &pitch) != 0) return 0;
+        Uint32 palette[TERRAIN_COUNT];
+        terrain_palette(palette);
+        mapimage_fill(pixels, pitch / 4, g_minimap_w, g_minimap_h, g_minimap_step, palette, 0xFF1E1E1Eu);
+        mapimage_apply_fog(pixels, pitch / 4, g_minimap_w, g_minimap_h, g_minimap_step, PLAYER_FACTION, 0xFF1E1E1Eu);
+        SDL_UnlockTexture(g_minimap_tex);
+        g_minimap_valid = 1;
+    }
+    return 1;
+}
+
+/* minimap pixel of layout point (x,y) (relative to the map origin) */
+static void minimap_from_layout(const SDL_Rect* box, double x, double y, int* out_x, int* out_y) {
+    int r = current_radius;
+    int step_x = r * 3 / 2;
+    double half_row = r * sqrt(3) / 2;
+    double fx = (x - (r - step_x / 2.0)) / ((double)g_minimap_w * g_minimap_step * step_x);
+    double fy = (y - (r - half_row)) / (g_minimap_h * g_minimap_step * half_row);
+    *out_x = box->x + (int)(fx * box->w);
+    *out_y = box->y + (int)(fy * box->h);
+}
+
+static void minimap_marker(SDL_Renderer* renderer, const SDL_Rect* box, int row, int col) {
+    int x, y, px, py;
+    hex_layout_center(row, col, current_radius, &x, &y);
+    minimap_from_layout(box, x, y, &px, &py);
+    SDL_Rect m = { px - 2, py - 2, 5, 5 };
+    SDL_RenderFillRect(renderer, &m);
+}
+
+void render_minimap(SDL_Renderer* renderer) {
+    if (!ensure_minimap_texture(renderer)) return;
+    SDL_Rect box;
+    minimap_layout(&box);
+    SDL_RenderCopy(renderer, g_minimap_tex, NULL, &box);
+
+    SDL_RenderSetClipRect(renderer, &box);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    if (player) {
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        minimap_marker(renderer, &box, SPRITE_FIELD(player, x), SPRITE_FIELD(player, y));
+    }
+    if (enemy && fog_visible(PLAYER_FACTION, SPRITE_FIELD(enemy, x), SPRITE_FIELD(enemy, y))) {
+        SDL_SetRenderDrawColor(renderer, 255, 40, 40, 255);
+        minimap_marker(renderer, &box, SPRITE_FIELD(enemy, x), SPRITE_FIELD(enemy, y));
+    }
+    /* visible part of the main view */
+    int x0, y0, x1, y1;
+    minimap_from_layout(&box, -cam_x - 50, -cam_y - 50, &x0, &y0);
+    minimap_from_layout(&box, g_main_width - cam_x - 50, g_window_height - cam_y - 50, &x1, &y1);
+    SDL_Rect view = { x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+    SDL_SetRenderDrawColor(renderer, 255, 220, 0, 220);
+    SDL_RenderDrawRect(renderer, &view);
+    SDL_RenderSetClipRect(renderer, NULL);
+
+    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 200);
+    SDL_RenderDrawRect(renderer, &box);
+}
+
+/* Center the main view on the map point under minimap pixel (mx,my).
+ * Returns 0 if the point is outside the minimap. */
+int minimap_jump(int mx, int my) {
+    SDL_Rect box;
+    minimap_layout(&box);
+    SDL_Point p = { mx, my };
+    if (!g_minimap_tex || !SDL_PointInRect(&p, &box)) return 0;
+    int r = current_radius;
+    int step_x = r * 3 / 2;
+    double half_row = r * sqrt(3) / 2;
+    double fx = (mx - box.x + 0.5) / box.w;
+    double fy = (my - box.y + 0.5) / box.h;
+    double x = (r - step_x / 2.0) + fx * g_minimap_w * g_minimap_step * step_x;
+    double y = (r - half_row) + fy * g_minimap_h * g_minimap_step * half_row;
+    cam_x = g_main_width / 2 - 50 - (int)x;
+    cam_y = g_window_height / 2 - 50 - (int)y;
+    clamp_camera();
+    return 1;
+}
+
+/* Carry out one enemy unit's plan and report its attack in the info panel. */
+static void apply_enemy_plan(const AiPlan* plan, void* user) {
+    SDL_Renderer* renderer = user;
+    int k = unit_index(plan->unit);
+    if (k < 0) return;
+    Sprite* s = g_units.owner[k];
+    if (plan->row != g_units.x[k] || plan->col != g_units.y[k]) sprite_set_position(s, plan->row, plan->col);
+    int t = unit_index(plan->target);
+    if (t < 0 || g_units.hp[t] <= 0) return;
+    Sprite* target = g_units.owner[t];
+    int damage = sprite_attack(s, target, plan->mode);
+    char info[256];
+    snprintf(info, sizeof(info), "%s attacks %s\n%d damage\n%s HP: %d/%d\n", s->name, target->name, damage,
+             target->name, SPRITE_FIELD(target, hp), SPRITE_FIELD(target, max_hp));
+    if (target == player && SPRITE_FIELD(player, hp) <= 0) {
+        strncat(info, "\n玩家被击败！", sizeof(info) - strlen(info) - 1);
+    }
+    create_text_texture(renderer, info);
+}
+
+/* Show rolling frame-phase timings in the right info panel. */
+void show_profiler_info(SDL_Renderer* renderer) {
+    char buf[PROF_PHASE_COUNT + 1][64];
+    const char* lines[PROF_PHASE_COUNT + 1];
+    snprintf(buf[0], sizeof(buf[0]), "=== Frame Profile (p50 / p99 ms) ===");
+    lines[0] = buf[0];
+    for (int i = 0; i < PROF_PHASE_COUNT; ++i) {
+        ProfStats st;
+        profiler_get_stats((ProfPhase)i, &st);
+        snprintf(buf[i + 1], sizeof(buf[i + 1]), "%-9s %6.2f / %6.2f", profiler_phase_name((ProfPhase)i), st.p50_ms, st.p99_ms);
+        lines[i + 1] = buf[i + 1];
+    }
+    set_info_lines(renderer, lines, PROF_PHASE_COUNT + 1);
+}
+
 int main(int argc, char* argv[]) {
     SDL_Init(SDL_INIT_VIDEO);
     if (TTF_Init() == -1) {
@@ -592,52 +1314,40 @@ int main(int argc, char* argv[]) {
         g_window_width, g_window_height,
         0
     );
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    g_map_rows = config_get_map_rows();
-    g_map_cols = config_get_map_cols();
-    g_terrain_map = (Terrain*)malloc(sizeof(Terrain) * g_map_rows * g_map_cols);
-    if (!g_terrain_map) {
-        fprintf(stderr, "Failed to allocate terrain map %dx%d\n", g_map_rows, g_map_cols);
-        return 1;
+    Uint32 render_flags = SDL_RENDERER_ACCELERATED;
+    if (config_get_vsync()) render_flags |= SDL_RENDERER_PRESENTVSYNC;
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, render_flags);
+    if (!renderer) renderer = SDL_CreateRenderer(window, -1, 0); /* fall back to any renderer */
+    /* with vsync, SDL_RenderPresent paces frames; otherwise we sleep to TARGET_FRAME_MS */
+    int vsync_active = 0;
+    SDL_RendererInfo render_info;
+    if (renderer && SDL_GetRendererInfo(renderer, &render_info) == 0) {
+        vsync_active = (render_info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
     }
-
     const char* font_path = config_get_font_path();
     int font_size = config_get_font_size();
     g_font = TTF_OpenFont(font_path, font_size);
     if (!g_font) {
         fprintf(stderr, "Failed to open font '%s': %s\n", font_path, TTF_GetError());
+    } else {
+        glyph_cache_init(&g_glyphs, font_glyph_advance, g_font);
     }
 
     /* 初始化地形：使用分形 Perlin 噪声生成更真实的地形 */
-    unsigned int seed = (unsigned)time(NULL);
-    /* initialize perlin with params from config */
-    PerlinParams pp;
-    config_get_perlin_params(&pp);
-    if (pp.seed == 0) pp.seed = seed;
-    perlin_init_with_params(&pp);
-
-    for (int r = 0; r < g_map_rows; r++) {
-        for (int c = 0; c < g_map_cols; c++) {
-            float elev = perlin_elevation((float)c, (float)r);
-            float m = perlin_moisture((float)c, (float)r);
-
-            Terrain t;
-            if (elev < 0.35f) {
-                t = TERRAIN_WATER;
-            } else if (elev > 0.85f) {
-                t = TERRAIN_MOUNTAIN;
-            } else if (elev > 0.6f) {
-                /* higher ground: hills or forest depending on moisture */
-                if (m > 0.55f) t = TERRAIN_FOREST;
-                else t = TERRAIN_HILLS;
-            } else {
-                /* low/medium ground: desert/plains/forest by moisture */
-                if (m < 0.28f) t = TERRAIN_DESERT;
-                else if (m > 0.65f) t = TERRAIN_FOREST;
-                else t = TERRAIN_PLAINS;
-            }
-            TERRAIN_AT(r,c) = t;
-        }
+    unsigned int seed = world_seed_from_config();
+    printf("World seed: %u\n", seed);
+    if (world_generate(config_get_map_rows(), config_get_map_cols()) != 0) {
+        fprintf(stderr, "Failed to allocate terrain map %dx%d\n", config_get_map_rows(), config_get_map_cols());
+        return 1;
+    }
+    /* unit index: who stands where */
+    if (spatial_init(g_map_rows, g_map_cols) != 0) {
+        fprintf(stderr, "Failed to allocate the unit index\n");
+        return 1;
+    }
+    /* fog of war (off: the whole map is revealed) */
+    if (config_get_fog() && fog_init(g_map_rows, g_map_cols) != 0) {
+        fprintf(stderr, "Failed to allocate fog of war, map fully revealed\n");
     }
 
     /* 计算地图边界并初始化相机限制 */
@@ -645,14 +1355,9 @@ int main(int argc, char* argv[]) {
     clamp_camera();
 
     /* Demo: create a randomized player sprite and an enemy sprite placed on the map */
-    srand((unsigned)time(NULL));
+    Rng *spawn_rng = rng_stream(RNG_STREAM_WORLDGEN);
 
     /* Load atlas texture and parse atlas file for frames */
-    SDL_Texture *atlas_tex = NULL;
-    SDL_Rect player_src = {0,0,16,16}, enemy_src = {0,0,16,16};
-    /* optional run animation frames for player loaded from atlas */
-    int player_run_x = 0, player_run_y = 0, player_run_w = 0, player_run_h = 0;
-    int player_run_frames = 0;
     if (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) {
         SDL_Surface *surf = IMG_Load("res/drawable/dungeon.png");
         if (surf) {
@@ -665,86 +1370,91 @@ int main(int argc, char* argv[]) {
         fprintf(stderr, "SDL_image PNG support not initialized\n");
     }
 
-    /* parse atlas description file for named entries */
-    FILE *af = fopen("res/drawable/dungeon", "r");
-    if (af) {
-        char name[256];
-        while (fscanf(af, "%255s", name) == 1) {
-            int x, y, w, h; int frames = 1;
-                if (fscanf(af, "%d %d %d %d", &x, &y, &w, &h) >= 4) {
-                    /* optional frames field */
-                    fscanf(af, "%d", &frames);
-                    if (strcmp(name, "knight_f_idle_anim") == 0) {
-                        player_src.x = x; player_src.y = y; player_src.w = w; player_src.h = h;
-                    } else if (strcmp(name, "knight_f_run_anim") == 0) {
-                        player_run_x = x; player_run_y = y; player_run_w = w; player_run_h = h; player_run_frames = frames > 0 ? frames : 1;
-                    } else if (strcmp(name, "big_zombie_idle_anim") == 0) {
-                        enemy_src.x = x; enemy_src.y = y; enemy_src.w = w; enemy_src.h = h;
-                    }
-            } else break;
-        }
-        fclose(af);
-    } else {
-        fprintf(stderr, "Failed to open atlas description file res/drawable/dungeon\n");
+    /* named regions of the atlas (binary sidecar when up to date) */
+    if (atlas_load(ATLAS_DESC_PATH) < 0) {
+        fprintf(stderr, "Failed to open atlas description file %s\n", ATLAS_DESC_PATH);
+    }
+    /* combat rules (built-in defaults if the file is missing) */
+    if (combat_rules_load(config_get_rules_path()) < 0) {
+        fprintf(stderr, "Combat rules %s not found, using defaults\n", config_get_rules_path());
     }
 
-    Sprite *player = sprite_create("Player", "Warrior", NULL, 1);
-    Sprite *enemy = sprite_create("Enemy", "Goblin", NULL, 1);
+    player = sprite_create("Player", "Warrior", "knight_f", 1);
+    enemy = sprite_create("Enemy", "Goblin", "big_zombie", 1);
+    sprite_bind_anims(player);
+    sprite_bind_anims(enemy);
     if (player) {
-        player->level = 1 + rand() % 10;
-        player->max_hp = 80 + rand() % (200 - 80 + 1);
-        player->hp = player->max_hp/2 + rand() % (player->max_hp - player->max_hp/2 + 1);
-        player->max_mp = 10 + rand() % (80 - 10 + 1);
-        player->mp = rand() % (player->max_mp + 1);
-        player->attack = 5 + rand() % (40 - 5 + 1);
-        player->defense = rand() % 31;
-        player->speed = 1 + rand() % 10;
-        player->move = 1 + rand() % 3;
-        player->jump = 1 + rand() % 3;
-        int pr = rand() % g_map_rows; int pc = rand() % g_map_cols;
+        SPRITE_FIELD(player, level) = 1 + rng_range(spawn_rng, 10);
+        SPRITE_FIELD(player, max_hp) = 80 + rng_range(spawn_rng, 200 - 80 + 1);
+        SPRITE_FIELD(player, hp) = SPRITE_FIELD(player, max_hp)/2 + rng_range(spawn_rng, SPRITE_FIELD(player, max_hp) - SPRITE_FIELD(player, max_hp)/2 + 1);
+        SPRITE_FIELD(player, max_mp) = 10 + rng_range(spawn_rng, 80 - 10 + 1);
+        SPRITE_FIELD(player, mp) = rng_range(spawn_rng, SPRITE_FIELD(player, max_mp) + 1);
+        SPRITE_FIELD(player, attack) = 5 + rng_range(spawn_rng, 40 - 5 + 1);
+        SPRITE_FIELD(player, defense) = rng_range(spawn_rng, 31);
+        SPRITE_FIELD(player, speed) = 1 + rng_range(spawn_rng, 10);
+        SPRITE_FIELD(player, move) = 1 + rng_range(spawn_rng, 3);
+        player->jump = 1 + rng_range(spawn_rng, 3);
+        int pr = rng_range(spawn_rng, g_map_rows); int pc = rng_range(spawn_rng, g_map_cols);
         sprite_set_position(player, pr, pc);
         printf("Player created at cell (%d,%d): lvl=%d HP=%d/%d MP=%d/%d ATK=%d DEF=%d\n",
-               player->x, player->y, player->level, player->hp, player->max_hp,
-               player->mp, player->max_mp, player->attack, player->defense);
+               SPRITE_FIELD(player, x), SPRITE_FIELD(player, y), SPRITE_FIELD(player, level), SPRITE_FIELD(player, hp), SPRITE_FIELD(player, max_hp),
+               SPRITE_FIELD(player, mp), SPRITE_FIELD(player, max_mp), SPRITE_FIELD(player, attack), SPRITE_FIELD(player, defense));
     }
     if (enemy) {
-        enemy->level = 1 + rand() % 8;
-        enemy->max_hp = 40 + rand() % (160 - 40 + 1);
-        enemy->hp = enemy->max_hp/2 + rand() % (enemy->max_hp - enemy->max_hp/2 + 1);
-        enemy->max_mp = rand() % 41;
-        enemy->mp = rand() % (enemy->max_mp + 1);
-        enemy->attack = 4 + rand() % (30 - 4 + 1);
-        enemy->defense = rand() % 21;
-        enemy->speed = 1 + rand() % 8;
-        enemy->move = 1 + rand() % 2;
-        enemy->jump = 1 + rand() % 2;
-        int er = rand() % g_map_rows; int ec = rand() % g_map_cols;
+        SPRITE_FIELD(enemy, level) = 1 + rng_range(spawn_rng, 8);
+        SPRITE_FIELD(enemy, max_hp) = 40 + rng_range(spawn_rng, 160 - 40 + 1);
+        SPRITE_FIELD(enemy, hp) = SPRITE_FIELD(enemy, max_hp)/2 + rng_range(spawn_rng, SPRITE_FIELD(enemy, max_hp) - SPRITE_FIELD(enemy, max_hp)/2 + 1);
+        SPRITE_FIELD(enemy, max_mp) = rng_range(spawn_rng, 41);
+        SPRITE_FIELD(enemy, mp) = rng_range(spawn_rng, SPRITE_FIELD(enemy, max_mp) + 1);
+        SPRITE_FIELD(enemy, attack) = 4 + rng_range(spawn_rng, 30 - 4 + 1);
+        SPRITE_FIELD(enemy, defense) = rng_range(spawn_rng, 21);
+        SPRITE_FIELD(enemy, speed) = 1 + rng_range(spawn_rng, 8);
+        SPRITE_FIELD(enemy, move) = 1 + rng_range(spawn_rng, 2);
+        SPRITE_FIELD(enemy, faction) = ENEMY_FACTION;
+        enemy->jump = 1 + rng_range(spawn_rng, 2);
+        int er = rng_range(spawn_rng, g_map_rows); int ec = rng_range(spawn_rng, g_map_cols);
         sprite_set_position(enemy, er, ec);
         printf("Enemy created at cell (%d,%d): lvl=%d HP=%d/%d MP=%d/%d ATK=%d DEF=%d\n",
-               enemy->x, enemy->y, enemy->level, enemy->hp, enemy->max_hp,
-               enemy->mp, enemy->max_mp, enemy->attack, enemy->defense);
+               SPRITE_FIELD(enemy, x), SPRITE_FIELD(enemy, y), SPRITE_FIELD(enemy, level), SPRITE_FIELD(enemy, hp), SPRITE_FIELD(enemy, max_hp),
+               SPRITE_FIELD(enemy, mp), SPRITE_FIELD(enemy, max_mp), SPRITE_FIELD(enemy, attack), SPRITE_FIELD(enemy, defense));
     }
 
-    /* movement state: when a path (path_nodes) is computed and an endpoint selected,
-        we will animate the player along the path at a configurable ms-per-tile speed. */
-    int moving = 0;
-    int move_index = 0; /* next index in path_nodes to move to (0 is start) */
-    Uint32 last_move_tick = 0;
+    /* movement speed (ms per tile) */
     int move_ms = config_get_move_ms();
     /* animation timing for run frames */
-    Uint32 last_anim_tick = 0;
-    int player_run_frame = 0;
+    double anim_elapsed_ms = 0.0;
     int anim_frame_ms = 120; /* ms per animation frame while running */
-    /* interpolation state for smooth movement between hex cells */
-    int move_from_r = -1, move_from_c = -1;
-    int move_to_r = -1, move_to_c = -1;
-    float move_progress = 0.0f; /* 0.0 .. 1.0 */
+
+    Uint32 last_profiler_hud_tick = 0;
+    /* movement/animation advance in fixed steps independent of frame rate */
+    FrameClock update_clock;
+    frame_clock_init(&update_clock, UPDATE_STEP_MS, 25);
+    /* set whenever something visible changed; idle frames are skipped */
+    int redraw = 1;
 
     int running = 1;
     SDL_Event event;
     while (running) {
+        double frame_start_ms = timing_now_ms();
+        /* nothing animating and nothing to redraw: sleep until input arrives */
+        if (!moving && !redraw && !ai_pending(&s_enemy_ai)) {
+            int wait_ms = IDLE_WAIT_MS;
+            if (show_profiler_enabled) {
+                Uint32 since = SDL_GetTicks() - last_profiler_hud_tick;
+                wait_ms = since >= PROFILER_HUD_MS ? 0 : (int)(PROFILER_HUD_MS - since);
+            }
+            SDL_WaitEventTimeout(NULL, wait_ms);
+            frame_start_ms = timing_now_ms();
+        }
+        profiler_begin(PROF_EVENTS);
         while (SDL_PollEvent(&event)) {
+            redraw = 1;
             if (event.type == SDL_QUIT) running = 0;
+            else if (event.type == SDL_RENDER_TARGETS_RESET) {
+                /* target texture contents were lost (e.g. device reset) */
+                g_terrain_cache_valid = 0;
+                dirty_mark_all();
+            }
             else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
                 int mx = event.button.x;
                 int my = event.button.y;
@@ -756,11 +1466,17 @@ int main(int argc, char* argv[]) {
                     cam_start_x = cam_x;
                     cam_start_y = cam_y;
                 }
-                /* clicks in info panel are ignored for map interactions */
+                /* minimap: jump there, and keep following the cursor until release */
+                else if (minimap_jump(mx, my)) {
+                    minimap_dragging = 1;
+                    hover_row = hover_col = -1;
+                }
+                /* other clicks in info panel are ignored for map interactions */
             }
             else if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_LEFT) {
                 int mx = event.button.x;
                 int my = event.button.y;
+                minimap_dragging = 0;
 
                 // 如果菜单显示但点击了菜单外部区域，关闭菜单
                 if (!menu_clicked) {
@@ -793,177 +1509,177 @@ int main(int argc, char* argv[]) {
                         create_text_texture(renderer, "Path cleared");
                     }
                     int found = 0;
-                    for (int row = 0; row < g_map_rows && !found; row++) {
-                        for (int col = 0; col < g_map_cols; col++) {
-                            int cx, cy;
-                            hex_center(row, col, current_radius, &cx, &cy);
-                            SDL_Point pts[6];
-                            compute_hex_points(cx, cy, current_radius-1, pts);
-                            if (!point_in_polygon(pts, 6, mx, my)) continue;
-                            /* path selection logic: first click = start, second click = end (compute path) */
-                            Terrain t = TERRAIN_AT(row,col);
-                            const char* names[] = {"Plains","Hills","Forest","Desert","Water","Mountain"};
-                            char info[256];
-                            if (attack_mode != ATTACK_MODE_NONE) {
-                                // 攻击模式：选择攻击目标
-                                if (enemy && enemy->x == row && enemy->y == col) {
-                                    // 计算攻击距离
-                                    int distance = hex_distance_cells(player->x, player->y, row, col);
-
-                                    if (distance <= attack_range) {
-                                        // 执行攻击
-                                        int damage = sprite_attack(player, enemy, attack_mode);
-
-                                        // 显示攻击结果
-                                        char attack_info[256];
-                                        const char* attack_type = (attack_mode == ATTACK_MODE_PHYSICAL) ? "Physical" : "Magic";
-                                        snprintf(attack_info, sizeof(attack_info),
-                                                "%s vs %s\n%d %s damage\n%sHP: %d/%d\n",
-                                                player->name, enemy->name, damage, attack_type,
-                                                enemy->name, enemy->hp, enemy->max_hp);
-
-                                        // 检查是否击败敌人
-                                        if (enemy->hp <= 0) {
-                                            strncat(attack_info, "\n敌人被击败！", sizeof(attack_info) - strlen(attack_info) - 1);
-                                        }
+                    int row, col;
+                    if (cell_at_screen(mx, my, &row, &col)) do {
+                        /* path selection logic: first click = start, second click = end (compute path) */
+                        Terrain t = TERRAIN_AT(row,col);
+                        const char* names[] = {"Plains","Hills","Forest","Desert","Water","Mountain"};
+                        char info[256];
+                        if (attack_mode != ATTACK_MODE_NONE) {
+                            // 攻击模式：选择攻击目标
+                            if (enemy && sprite_at(row, col) == enemy) {
+                                // 计算攻击距离
+                                int distance = hex_distance_cells(SPRITE_FIELD(player, x), SPRITE_FIELD(player, y), row, col);
+
+                                const FovMask *view = fov_unit(player->unit);
+                                if (distance <= attack_range && view && !fov_visible(view, row, col)) {
+                                    create_text_texture(renderer, "目标不在视野内！");
+                                    found = 1;
+                                    break;
+                                } else if (distance <= attack_range) {
+                                    // 执行攻击
+                                    int damage = sprite_attack(player, enemy, attack_mode);
+
+                                    // 显示攻击结果
+                                    char attack_info[256];
+                                    const char* attack_type = (attack_mode == ATTACK_MODE_PHYSICAL) ? "Physical" : "Magic";
+                                    snprintf(attack_info, sizeof(attack_info),
+                                            "%s vs %s\n%d %s damage\n%sHP: %d/%d\n",
+                                            player->name, enemy->name, damage, attack_type,
+                                            enemy->name, SPRITE_FIELD(enemy, hp), SPRITE_FIELD(enemy, max_hp));
+
+                                    // 检查是否击败敌人
+                                    if (SPRITE_FIELD(enemy, hp) <= 0) {
+                                        strncat(attack_info, "\n敌人被击败！", sizeof(attack_info) - strlen(attack_info) - 1);
+                                    }
 
-                                        create_text_texture(renderer, attack_info);
+                                    create_text_texture(renderer, attack_info);
 
-                                        // 退出攻击模式
-                                        attack_mode = ATTACK_MODE_NONE;
-                                        found = 1;
-                                        break;
-                                    } else {
-                                        snprintf(info, sizeof(info), "目标超出攻击范围！距离: %d, 范围: %d",
-                                                distance, attack_range);
-                                        create_text_texture(renderer, info);
-                                        found = 1;
-                                        break;
-                                    }
+                                    // 退出攻击模式，轮到敌方行动
+                                    attack_mode = ATTACK_MODE_NONE;
+                                    ai_begin_turn(&s_enemy_ai, ENEMY_FACTION);
+                                    found = 1;
+                                    break;
                                 } else {
-                                    snprintf(info, sizeof(info), "请选择有效的攻击目标（敌人）");
+                                    snprintf(info, sizeof(info), "目标超出攻击范围！距离: %d, 范围: %d",
+                                            distance, attack_range);
                                     create_text_texture(renderer, info);
                                     found = 1;
                                     break;
                                 }
+                            } else {
+                                snprintf(info, sizeof(info), "请选择有效的攻击目标（敌人）");
+                                create_text_texture(renderer, info);
+                                found = 1;
+                                break;
                             }
+                        }
 
-                            if (path_start_row == -1) {
-                                /* set start */
-                                /* only allow start if the clicked cell contains the player */
-                                if (!player || player->x != row || player->y != col) {
-                                    snprintf(info, sizeof(info), "Start must be player cell");
-                                    create_text_texture(renderer, info);
-                                    found = 1; break;
-                                }
-
-                                // 点击玩家角色时显示菜单
-                                if (player && player->x == row && player->y == col) {
-                                    show_player_menu = 1;
-                                    menu_selected_option = 0;
-                                    // 设置菜单位置在玩家角色附近
-                                    int cx, cy;
-                                    hex_center(row, col, current_radius, &cx, &cy);
-                                    menu_x = cx + current_radius;
-                                    menu_y = cy;
-                                    // 确保菜单不会超出窗口边界
-                                    if (menu_x + menu_width > g_main_width) {
-                                        menu_x = cx - menu_width - current_radius;
-                                    }
-                                    if (menu_y + menu_height > g_window_height) {
-                                        menu_y = g_window_height - menu_height - 10;
-                                    }
-                                    snprintf(info, sizeof(info), "玩家菜单已打开");
-                                    found = 1; break;
-                                }
+                        if (path_start_row == -1) {
+                            /* set start */
+                            /* only allow start if the clicked cell contains the player */
+                            if (!player || sprite_at(row, col) != player) {
+                                snprintf(info, sizeof(info), "Start must be player cell");
+                                create_text_texture(renderer, info);
+                                found = 1; break;
+                            }
 
-                                path_start_row = row; path_start_col = col;
-                                /* mark selection for highlighting */
-                                selected_row = row; selected_col = col;
-                                /* clear any previous path */
-                                if (in_path) memset(in_path, 0, g_map_rows * g_map_cols);
-                                path_preview_row = path_preview_col = -1;
-                                snprintf(info, sizeof(info), "Start: (%d,%d) Terrain: %s", row, col, names[t]);
-                            } else if (path_start_row == row && path_start_col == col) {
-                                /* clicked start again -> clear start */
-                                path_start_row = path_start_col = -1;
-                                if (in_path) memset(in_path, 0, g_map_rows * g_map_cols);
-                                path_preview_row = path_preview_col = -1;
-                                snprintf(info, sizeof(info), "Start cleared (%d,%d)", row, col);
-                                /* clear selection highlight when clearing start */
-                                selected_row = selected_col = -1;
-                            } else if (path_end_row == -1) {
-                                /* set end and compute path */
-                                /* disallow choosing an end that is occupied by player or enemy */
-                                if (player && player->x == row && player->y == col) {
-                                    snprintf(info, sizeof(info), "End cannot be player's cell");
-                                    create_text_texture(renderer, info);
-                                    found = 1; break;
+                            // 点击玩家角色时显示菜单
+                            if (player && sprite_at(row, col) == player) {
+                                show_player_menu = 1;
+                                menu_selected_option = 0;
+                                // 设置菜单位置在玩家角色附近
+                                int cx, cy;
+                                hex_center(row, col, current_radius, &cx, &cy);
+                                menu_x = cx + current_radius;
+                                menu_y = cy;
+                                // 确保菜单不会超出窗口边界
+                                if (menu_x + menu_width > g_main_width) {
+                                    menu_x = cx - menu_width - current_radius;
                                 }
-                                if (enemy && enemy->x == row && enemy->y == col) {
-                                    snprintf(info, sizeof(info), "End cannot be enemy's cell");
-                                    create_text_texture(renderer, info);
-                                    found = 1; break;
+                                if (menu_y + menu_height > g_window_height) {
+                                    menu_y = g_window_height - menu_height - 10;
                                 }
-                                path_end_row = row; path_end_col = col;
-                                /* mark selection */
-                                selected_row = row; selected_col = col;
-                                snprintf(info, sizeof(info), "End: (%d,%d) Terrain: %s", row, col, names[t]);
-                                compute_path(path_start_row, path_start_col, path_end_row, path_end_col);
-                                /* end selected: disable hover preview (keep this computed path as final) */
-                                path_preview_row = path_preview_col = -1;
-                                /* build path coordinate string for UI (truncate if long) */
-                                if (path_len > 0) {
-                                    char pbuf[1024];
-                                    int pos = snprintf(pbuf, sizeof(pbuf), "Path len: %d  ", path_len);
-                                    for (int pi = 0; pi < path_len; ++pi) {
-                                        int idx = path_nodes[pi];
-                                        int pr = idx / g_map_cols, pc = idx % g_map_cols;
-                                        int n = snprintf(pbuf + pos, sizeof(pbuf) - pos, "(%d,%d)%s", pr, pc, (pi + 1 < path_len) ? "->" : "");
-                                        pos += n;
-                                        if (pos > (int)sizeof(pbuf) - 80) { snprintf(pbuf + pos, sizeof(pbuf) - pos, " ..."); break; }
-                                    }
-                                    /* append to the end of info */
-                                    strncat(info, "  ", sizeof(info) - strlen(info) - 1);
-                                    strncat(info, pbuf, sizeof(info) - strlen(info) - 1);
-                                } else {
-                                    strncat(info, "  No path found", sizeof(info) - strlen(info) - 1);
+                                snprintf(info, sizeof(info), "玩家菜单已打开");
+                                found = 1; break;
+                            }
+
+                            path_start_row = row; path_start_col = col;
+                            /* mark selection for highlighting */
+                            selected_row = row; selected_col = col;
+                            /* clear any previous path */
+                            if (in_path) memset(in_path, 0, g_map_rows * g_map_cols);
+                            path_preview_row = path_preview_col = -1;
+                            snprintf(info, sizeof(info), "Start: (%d,%d) Terrain: %s", row, col, names[t]);
+                        } else if (path_start_row == row && path_start_col == col) {
+                            /* clicked start again -> clear start */
+                            path_start_row = path_start_col = -1;
+                            if (in_path) memset(in_path, 0, g_map_rows * g_map_cols);
+                            path_preview_row = path_preview_col = -1;
+                            snprintf(info, sizeof(info), "Start cleared (%d,%d)", row, col);
+                            /* clear selection highlight when clearing start */
+                            selected_row = selected_col = -1;
+                        } else if (path_end_row == -1) {
+                            /* set end and compute path */
+                            /* disallow choosing an end that is occupied by player or enemy */
+                            Sprite* occupant = sprite_at(row, col);
+                            if (occupant && occupant == player) {
+                                snprintf(info, sizeof(info), "End cannot be player's cell");
+                                create_text_texture(renderer, info);
+                                found = 1; break;
+                            }
+                            if (occupant) {
+                                snprintf(info, sizeof(info), "End cannot be enemy's cell");
+                                create_text_texture(renderer, info);
+                                found = 1; break;
+                            }
+                            path_end_row = row; path_end_col = col;
+                            /* mark selection */
+                            selected_row = row; selected_col = col;
+                            snprintf(info, sizeof(info), "End: (%d,%d) Terrain: %s", row, col, names[t]);
+                            compute_path(path_start_row, path_start_col, path_end_row, path_end_col);
+                            /* end selected: disable hover preview (keep this computed path as final) */
+                            path_preview_row = path_preview_col = -1;
+                            /* build path coordinate string for UI (truncate if long) */
+                            if (path_len > 0) {
+                                char pbuf[1024];
+                                int pos = snprintf(pbuf, sizeof(pbuf), "Path len: %d  ", path_len);
+                                for (int pi = 0; pi < path_len; ++pi) {
+                                    int idx = path_nodes[pi];
+                                    int pr = idx / g_map_cols, pc = idx % g_map_cols;
+                                    int n = snprintf(pbuf + pos, sizeof(pbuf) - pos, "(%d,%d)%s", pr, pc, (pi + 1 < path_len) ? "->" : "");
+                                    pos += n;
+                                    if (pos > (int)sizeof(pbuf) - 80) { snprintf(pbuf + pos, sizeof(pbuf) - pos, " ..."); break; }
                                 }
-                                /* if a path was found, begin moving the player along it */
-                                if (path_len > 1) {
-                                                /* start movement from index 1 (0 is current player cell) */
-                                                moving = 1;
-                                                move_index = 1;
-                                                last_move_tick = SDL_GetTicks();
-                                                last_anim_tick = last_move_tick;
-                                                player_run_frame = 0;
-                                                /* initialize interpolation from current cell to first target */
-                                                move_progress = 0.0f;
-                                                if (path_nodes) {
-                                                    int idx0 = path_nodes[0];
-                                                    int idx1 = path_nodes[1];
-                                                    move_from_r = idx0 / g_map_cols; move_from_c = idx0 % g_map_cols;
-                                                    move_to_r = idx1 / g_map_cols; move_to_c = idx1 % g_map_cols;
-                                                }
-                                            } else if (path_len == 1) {
-                                                /* trivial path: already at destination */
-                                                create_text_texture(renderer, "Path is current cell");
-                                            }
+                                /* append to the end of info */
+                                strncat(info, "  ", sizeof(info) - strlen(info) - 1);
+                                strncat(info, pbuf, sizeof(info) - strlen(info) - 1);
                             } else {
-                                /* both set: start a new start */
-                                path_start_row = row; path_start_col = col;
-                                path_end_row = path_end_col = -1;
-                                if (in_path) memset(in_path, 0, g_map_rows * g_map_cols);
-                                path_preview_row = path_preview_col = -1;
-                                /* clear previous end highlight and highlight the new start */
-                                selected_row = row; selected_col = col;
-                                snprintf(info, sizeof(info), "Start: (%d,%d) Terrain: %s", row, col, names[t]);
+                                strncat(info, "  No path found", sizeof(info) - strlen(info) - 1);
                             }
-                            create_text_texture(renderer, info);
-                            found = 1;
-                            break;
+                            /* if a path was found, begin moving the player along it */
+                            if (path_len > 1) {
+                                            /* start movement from index 1 (0 is current player cell) */
+                                            moving = 1;
+                                            move_index = 1;
+                                            frame_clock_reset(&update_clock, timing_now_ms());
+                                            anim_elapsed_ms = 0.0;
+                                            player_run_frame = 0;
+                                            /* initialize interpolation from current cell to first target */
+                                            move_progress = 0.0f;
+                                            if (path_nodes) {
+                                                int idx0 = path_nodes[0];
+                                                int idx1 = path_nodes[1];
+                                                move_from_r = idx0 / g_map_cols; move_from_c = idx0 % g_map_cols;
+                                                move_to_r = idx1 / g_map_cols; move_to_c = idx1 % g_map_cols;
+                                            }
+                                        } else if (path_len == 1) {
+                                            /* trivial path: already at destination */
+                                            create_text_texture(renderer, "Path is current cell");
+                                        }
+                        } else {
+                            /* both set: start a new start */
+                            path_start_row = row; path_start_col = col;
+                            path_end_row = path_end_col = -1;
+                            if (in_path) memset(in_path, 0, g_map_rows * g_map_cols);
+                            path_preview_row = path_preview_col = -1;
+                            /* clear previous end highlight and highlight the new start */
+                            selected_row = row; selected_col = col;
+                            snprintf(info, sizeof(info), "Start: (%d,%d) Terrain: %s", row, col, names[t]);
                         }
-                    }
+                        create_text_texture(renderer, info);
+                        found = 1;
+                    } while (0);
                     if (!found) {
                         /* click on empty map area - clear selection and path start/end */
                         selected_row = selected_col = -1;
@@ -972,7 +1688,7 @@ int main(int argc, char* argv[]) {
                         if (in_path) memset(in_path, 0, g_map_rows * g_map_cols);
                         path_preview_row = path_preview_col = -1;
                         SDL_SetWindowTitle(window, "Hex Terrain Map");
-                        if (g_info_tex) { SDL_DestroyTexture(g_info_tex); g_info_tex = NULL; }
+                        clear_info_text();
                     }
 
                     // 检查是否点击了菜单
@@ -990,15 +1706,15 @@ int main(int argc, char* argv[]) {
                                 switch (i) {
                                     case MENU_MOVE:
                                         // 移动模式：设置路径起点
-                                        path_start_row = player->x;
-                                        path_start_col = player->y;
-                                        selected_row = player->x;
-                                        selected_col = player->y;
+                                        path_start_row = SPRITE_FIELD(player, x);
+                                        path_start_col = SPRITE_FIELD(player, y);
+                                        selected_row = SPRITE_FIELD(player, x);
+                                        selected_col = SPRITE_FIELD(player, y);
                                         snprintf(info, sizeof(info), "Move Mode: Select Target Position");
                                         break;
                                     case MENU_ATTACK:
                                         // 攻击模式：显示可攻击范围
-                                        attack_mode = get_attack_mode(player->job);
+                                        attack_mode = job_attack_mode((JobType)SPRITE_FIELD(player, job));
                                         snprintf(info, sizeof(info), "Attack Mode: Select Target (%s)",
                                             attack_mode == ATTACK_MODE_PHYSICAL ? "Physical" : "Magic");
                                         break;
@@ -1025,10 +1741,8 @@ int main(int argc, char* argv[]) {
                     }
 
                     if (!found && selected_row >= 0 && selected_col >= 0) {
-                        if (player && player->x == selected_row && player->y == selected_col)
-                            show_sprite_info(renderer, player);
-                        else if (enemy && enemy->x == selected_row && enemy->y == selected_col)
-                            show_sprite_info(renderer, enemy);
+                        Sprite* selected = sprite_at(selected_row, selected_col);
+                        if (selected) show_sprite_info(renderer, selected);
                     }
                 }
                 /* end dragging */
@@ -1042,6 +1756,8 @@ int main(int argc, char* argv[]) {
                     int old_r = current_radius;
                     float factor = (event.wheel.y > 0) ? 1.1f : 0.9f;
                     int new_r = (int) (old_r * factor + 0.5f);
+                    /* small radii would round back to themselves */
+                    if (new_r == old_r) new_r += (event.wheel.y > 0) ? 1 : -1;
                     if (new_r < MIN_RADIUS) new_r = MIN_RADIUS;
                     if (new_r > MAX_RADIUS) new_r = MAX_RADIUS;
                     if (new_r != old_r) {
@@ -1063,6 +1779,8 @@ int main(int argc, char* argv[]) {
                     cam_y = cam_start_y + (my - drag_start_y);
                     clamp_camera();
                     hover_row = hover_col = -1;
+                } else if (minimap_dragging) {
+                    minimap_jump(mx, my);
                 } else {
                     /* only hover test when cursor is over main map area */
                     if (mx < g_main_width) {
@@ -1085,15 +1803,9 @@ int main(int argc, char* argv[]) {
 
                         // 如果不在菜单上，检查地图单元格
                         if (!found) {
-                            for (int row = 0; row < g_map_rows && !found; row++) {
-                                for (int col = 0; col < g_map_cols; col++) {
-                                    int cx, cy; SDL_Point pts[6];
-                                    hex_center(row, col, current_radius, &cx, &cy);
-                                    compute_hex_points(cx, cy, current_radius-1, pts);
-                                    if (point_in_polygon(pts, 6, mx, my)) {
-                                        hover_row = row; hover_col = col; found = 1; break;
-                                    }
-                                }
+                            int row, col;
+                            if (cell_at_screen(mx, my, &row, &col)) {
+                                hover_row = row; hover_col = col; found = 1;
                             }
                             if (!found) { hover_row = hover_col = -1; }
                         }
@@ -1137,10 +1849,10 @@ int main(int argc, char* argv[]) {
                             char info[256];
                             switch (menu_selected_option) {
                                 case MENU_MOVE:
-                                    path_start_row = player->x;
-                                    path_start_col = player->y;
-                                    selected_row = player->x;
-                                    selected_col = player->y;
+                                    path_start_row = SPRITE_FIELD(player, x);
+                                    path_start_col = SPRITE_FIELD(player, y);
+                                    selected_row = SPRITE_FIELD(player, x);
+                                    selected_col = SPRITE_FIELD(player, y);
                                     snprintf(info, sizeof(info), "移动模式：选择目标位置");
                                     break;
                                 case MENU_ATTACK:
@@ -1174,82 +1886,27 @@ int main(int argc, char* argv[]) {
                         char info[128];
                         snprintf(info, sizeof(info), "Show cell coords: %s", show_cell_coords_enabled ? "ON" : "OFF");
                         create_text_texture(renderer, info);
+                    } else if (event.key.keysym.sym == SDLK_p) {
+                        show_profiler_enabled = !show_profiler_enabled;
+                        if (show_profiler_enabled) {
+                            show_profiler_info(renderer);
+                            last_profiler_hud_tick = SDL_GetTicks();
+                        } else {
+                            create_text_texture(renderer, "Frame profiler: OFF");
+                        }
                     }
                 }
             }
         }
-        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255); // 背景色
-        SDL_RenderClear(renderer);
-
-        /* restrict drawing of map to main map area (left pane) */
-        SDL_Rect main_view = {0, 0, g_main_width, g_window_height};
-        SDL_RenderSetViewport(renderer, &main_view);
-
-        // 绘制六边形地图，根据地形设置颜色
-        for (int row = 0; row < g_map_rows; row++) {
-            for (int col = 0; col < g_map_cols; col++) {
-                int cx, cy;
-                hex_center(row, col, current_radius, &cx, &cy);
-                draw_hex_terrain(renderer, cx, cy, current_radius - 1, TERRAIN_AT(row,col));
-
-                if (show_cell_coords_enabled && current_radius >= COORDS_SHOW_MIN_RADIUS) {
-                    char coordbuf[32];
-                    snprintf(coordbuf, sizeof(coordbuf), "%d,%d", row, col);
-                    int tw=0, th=0;
-                    SDL_Texture* ttx = create_text_texture_local(renderer, coordbuf, &tw, &th);
-                    if (ttx) {
-                        SDL_SetTextureBlendMode(ttx, SDL_BLENDMODE_BLEND);
-                        SDL_Rect td = { cx - tw/2, cy - th/2, tw, th };
-                        SDL_RenderCopy(renderer, ttx, NULL, &td);
-                        SDL_DestroyTexture(ttx);
-                    }
-                }
-
-                int idx = idx_of(row,col);
-                if (in_path && in_path[idx]) {
-                    SDL_Point pts[6];
-                    compute_hex_points(cx, cy, current_radius - 1, pts);
-                    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-                    SDL_SetRenderDrawColor(renderer, 0, 200, 200, 140);
-                    fill_polygon(renderer, pts, 6);
-                }
-                // 如果被选中，高亮边框
-                if (row == selected_row && col == selected_col) {
-                    SDL_Point pts[6];
-                    compute_hex_points(cx, cy, current_radius - 1, pts);
-                    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-                    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 200);
-                    // 再次绘制边框以示高亮
-                    SDL_RenderDrawLines(renderer, pts, 6);
-                    SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
-                }
-
-                // 攻击模式下高亮显示攻击范围内的敌人
-                if (attack_mode != ATTACK_MODE_NONE && player) {
-                    int distance = hex_distance_cells(player->x, player->y, row, col);
-                    if (enemy && enemy->x == row && enemy->y == col && distance <= attack_range) {
-                        SDL_Point pts[6];
-                        compute_hex_points(cx, cy, current_radius - 1, pts);
-                        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-                        SDL_SetRenderDrawColor(renderer, 255, 50, 50, 120);
-                        fill_polygon(renderer, pts, 6);
-                        // 红色边框表示可攻击目标
-                        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 200);
-                        SDL_RenderDrawLines(renderer, pts, 6);
-                        SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
-                    }
-                }
-            }
-        }
-
+        profiler_end(PROF_EVENTS);
         /* Advance movement along path with interpolation and update run animation frame */
-        {
-            Uint32 now = SDL_GetTicks();
+        profiler_begin(PROF_UPDATE);
+        int update_steps = frame_clock_advance(&update_clock, timing_now_ms());
+        for (int step = 0; step < update_steps; ++step) {
             if (moving && path_len > 1 && path_nodes && move_index < path_len) {
                 if (move_ms <= 0) move_ms = 200;
-                Uint32 dt = now - last_move_tick;
-                last_move_tick = now;
-                move_progress += (float)dt / (float)move_ms;
+                move_progress += (float)(UPDATE_STEP_MS / move_ms);
+                redraw = 1;
 
                 /* complete one or more steps if progress overflowed (supports large dt) */
                 while (move_progress >= 1.0f && moving) {
@@ -1274,14 +1931,17 @@ int main(int argc, char* argv[]) {
                         move_from_r = move_from_c = move_to_r = move_to_c = -1;
                         move_progress = 0.0f;
                         create_text_texture(renderer, "Movement complete");
+                        ai_begin_turn(&s_enemy_ai, ENEMY_FACTION);
                         break;
                     }
                 }
 
                 /* update animation frame */
-                if (player_run_frames > 0 && now - last_anim_tick >= (Uint32)anim_frame_ms) {
-                    player_run_frame = (player_run_frame + 1) % player_run_frames;
-                    last_anim_tick = now;
+                anim_elapsed_ms += UPDATE_STEP_MS;
+                const AtlasEntry* run_anim = player ? atlas_entry(player->anim_run) : NULL;
+                if (run_anim && anim_elapsed_ms >= anim_frame_ms) {
+                    player_run_frame = (player_run_frame + 1) % run_anim->frames;
+                    anim_elapsed_ms = 0.0;
                 }
             } else {
                 player_run_frame = 0;
@@ -1289,113 +1949,42 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        /* Draw sprites (player, enemy) if atlas loaded */
-        if (atlas_tex) {
-            if (player) {
-                /* compute rendered pixel center: interpolated when moving, otherwise snap to player's cell */
-                int render_x, render_y;
-                if (moving && move_from_r >= 0 && move_to_r >= 0) {
-                    int fx, fy, tx, ty;
-                    hex_center(move_from_r, move_from_c, current_radius, &fx, &fy);
-                    hex_center(move_to_r, move_to_c, current_radius, &tx, &ty);
-                    float t = move_progress;
-                    if (t < 0.0f) t = 0.0f; if (t > 1.0f) t = 1.0f;
-                    render_x = (int)(fx + (tx - fx) * t + 0.5f);
-                    render_y = (int)(fy + (ty - fy) * t + 0.5f);
-                } else {
-                    int pr = player->x, pc = player->y;
-                    hex_center(pr, pc, current_radius, &render_x, &render_y);
-                }
-                /* choose source rect: running frames when moving, otherwise idle */
-                SDL_Rect cur_src = player_src;
-                if (moving && player_run_frames > 0 && player_run_w > 0) {
-                    cur_src.x = player_run_x + player_run_frame * player_run_w;
-                    cur_src.y = player_run_y;
-                    cur_src.w = player_run_w;
-                    cur_src.h = player_run_h;
-                }
-                double hex_w = current_radius * 2.0;
-                double hex_h = current_radius * sqrt(3.0);
-                const double pad = 0.9; /* keep some padding inside the hex */
-                double scale_w = (hex_w * pad) / (double)cur_src.w;
-                double scale_h = (hex_h * pad) / (double)cur_src.h;
-                double scale = scale_w < scale_h ? scale_w : scale_h;
-                if (scale <= 0.0) scale = 1.0;
-                int dw = (int)(cur_src.w * scale + 0.5);
-                int dh = (int)(cur_src.h * scale + 0.5);
-                SDL_Rect dst = { render_x - dw/2, render_y - dh/2, dw, dh };
-                SDL_RenderCopy(renderer, atlas_tex, &cur_src, &dst);
-            }
-            if (enemy) {
-                int er = enemy->x, ec = enemy->y;
-                int ex, ey; hex_center(er, ec, current_radius, &ex, &ey);
-                double hex_w = current_radius * 2.0;
-                double hex_h = current_radius * sqrt(3.0);
-                const double pad = 0.9;
-                double scale_w = (hex_w * pad) / (double)enemy_src.w;
-                double scale_h = (hex_h * pad) / (double)enemy_src.h;
-                double scale = scale_w < scale_h ? scale_w : scale_h;
-                if (scale <= 0.0) scale = 1.0;
-                int dw = (int)(enemy_src.w * scale + 0.5);
-                int dh = (int)(enemy_src.h * scale + 0.5);
-                SDL_Rect dst = { ex - dw/2, ey - dh/2, dw, dh };
-                SDL_RenderCopy(renderer, atlas_tex, &enemy_src, &dst);
-            }
-        }
+        profiler_end(PROF_UPDATE);
 
-        // 绘制邻居高亮（如果启用并有悬停单元）
-        if (highlight_neighbors_enabled && hover_row >= 0 && hover_col >= 0) {
-            int nbr_r[6], nbr_c[6];
-            int nc = get_neighbors(hover_row, hover_col, nbr_r, nbr_c);
-            SDL_Point pts[6];
-            for (int i = 0; i < nc; ++i) {
-                int rr = nbr_r[i], cc = nbr_c[i];
-                int cx, cy; hex_center(rr, cc, current_radius, &cx, &cy);
-                compute_hex_points(cx, cy, current_radius - 1, pts);
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-                SDL_SetRenderDrawColor(renderer, 255, 220, 0, 120);
-                fill_polygon(renderer, pts, 6);
-                SDL_SetRenderDrawColor(renderer, 255, 220, 0, 200);
-                SDL_RenderDrawLines(renderer, pts, 6);
-                SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
-            }
-            /* highlight hovered cell differently */
-            int hcx, hcy; hex_center(hover_row, hover_col, current_radius, &hcx, &hcy);
-            compute_hex_points(hcx, hcy, current_radius - 1, pts);
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 160);
-            SDL_RenderDrawLines(renderer, pts, 6);
-            SDL_RenderDrawLine(renderer, pts[5].x, pts[5].y, pts[0].x, pts[0].y);
+        /* enemy turn: plan within a per-frame budget so the frame keeps its pace */
+        if (ai_pending(&s_enemy_ai)) {
+            profiler_begin(PROF_AI);
+            ai_plan_step(&s_enemy_ai, AI_FRAME_BUDGET_MS, apply_enemy_plan, renderer);
+            profiler_end(PROF_AI);
+            redraw = 1;
         }
 
-        // 绘制路径线段（如果存在）
-        if (path_len >= 2 && path_nodes) {
-            SDL_Point *pline = malloc(sizeof(SDL_Point) * path_len);
-            for (int i = 0; i < path_len; ++i) {
-                int idx = path_nodes[i];
-                int pr = idx / g_map_cols, pc = idx % g_map_cols;
-                hex_center(pr, pc, current_radius, &pline[i].x, &pline[i].y);
-            }
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            SDL_SetRenderDrawColor(renderer, 255, 80, 80, 220);
-            SDL_RenderDrawLines(renderer, pline, path_len);
-            // draw endpoints
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            SDL_Rect rs = { pline[0].x - 4, pline[0].y - 4, 8, 8 };
-            SDL_Rect re = { pline[path_len-1].x - 4, pline[path_len-1].y - 4, 8, 8 };
-            SDL_RenderFillRect(renderer, &rs);
-            SDL_RenderFillRect(renderer, &re);
-            free(pline);
-        }
+        /* the profiler HUD needs a frame even when idle */
+        if (show_profiler_enabled && SDL_GetTicks() - last_profiler_hud_tick >= PROFILER_HUD_MS) redraw = 1;
+        if (!redraw && !moving) continue;
+
+        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255); // 背景色
+        SDL_RenderClear(renderer);
+
+        /* map area (left pane): cached terrain plus redrawn dirty regions */
+        render_map_view(renderer);
 
         /* restore full-window viewport for UI/info panel */
         SDL_RenderSetViewport(renderer, NULL);
+        profiler_begin(PROF_UI);
+
+        if (show_profiler_enabled && SDL_GetTicks() - last_profiler_hud_tick >= PROFILER_HUD_MS) {
+            show_profiler_info(renderer);
+            last_profiler_hud_tick = SDL_GetTicks();
+        }
+
+        render_minimap(renderer);
 
         // 渲染玩家菜单（在信息面板之前渲染）
         render_player_menu(renderer);
 
         // 绘制信息纹理（信息面板，右侧）
-        if (g_info_tex) {
+        if (g_info_nlines > 0) {
             int info_x = g_main_width + 10;
             int panel_width = get_info_panel_width();
 
@@ -1405,9 +1994,11 @@ int main(int argc, char* argv[]) {
                 display_width = panel_width;
             }
 
-            // 确保文本高度不会超出窗口高度
+            // 确保文本高度不会超出窗口高度（底部留给小地图）
             int display_height = g_info_h;
-            int max_height = g_window_height - 20; // 留出上下边距
+            SDL_Rect minimap_box;
+            minimap_layout(&minimap_box);
+            int max_height = minimap_box.y - 30; // 留出上下边距
             if (display_height > max_height) {
                 display_height = max_height;
             }
@@ -1420,25 +2011,65 @@ int main(int argc, char* argv[]) {
             SDL_SetRenderDrawColor(renderer, 100, 100, 100, 200);
             SDL_RenderDrawRect(renderer, &bg);
 
-            SDL_Rect dst = { info_x + 5, 14, display_width, display_height };
-            SDL_RenderCopy(renderer, g_info_tex, NULL, &dst);
+            SDL_Rect clip = { info_x + 5, 14, display_width, display_height };
+            SDL_RenderSetClipRect(renderer, &clip);
+            SDL_Color col = {255,255,255,255};
+            int y = clip.y;
+            for (int i = 0; i < g_info_nlines && y < clip.y + clip.h; ++i) {
+                int tw = 0, th = 0;
+                SDL_Texture* line_tex = textcache_get(renderer, g_font, g_info_lines[i], col, &tw, &th);
+                if (line_tex) {
+                    SDL_Rect dst = { clip.x, y, tw, th };
+                    SDL_RenderCopy(renderer, line_tex, NULL, &dst);
+                } else {
+                    th = TTF_FontHeight(g_font);
+                }
+                y += th + g_info_spacing;
+            }
+            SDL_RenderSetClipRect(renderer, NULL);
         }
 
+        profiler_end(PROF_UI);
+
+        profiler_begin(PROF_PRESENT);
         SDL_RenderPresent(renderer);
-        SDL_Delay(16);
+        profiler_end(PROF_PRESENT);
+        redraw = 0;
+        /* without vsync, sleep only for what is left of the frame budget */
+        if (!vsync_active) {
+            double spent_ms = timing_now_ms() - frame_start_ms;
+            if (spent_ms < TARGET_FRAME_MS) SDL_Delay((Uint32)(TARGET_FRAME_MS - spent_ms));
+        }
+        profiler_frame_end();
+    }
+
+    const char* profile_csv = config_get_profile_csv();
+    if (profile_csv[0] && profiler_write_csv(profile_csv) != 0) {
+        fprintf(stderr, "Failed to write profile CSV '%s'\n", profile_csv);
     }
 
+    destroy_layer_textures();
     /* cleanup atlas texture and SDL_image */
     if (atlas_tex) SDL_DestroyTexture(atlas_tex);
+    sprite_batch_free(&s_sprite_batch);
+    atlas_free();
     IMG_Quit();
+    clear_info_text();
+    textcache_clear();
     SDL_DestroyRenderer(renderer);
-    if (g_info_tex) SDL_DestroyTexture(g_info_tex);
     if (g_font) TTF_CloseFont(g_font);
     /* destroy demo sprites if present (created earlier in main) */
     if (player) sprite_destroy(player);
     if (enemy) sprite_destroy(enemy);
+    ai_free(&s_enemy_ai);
+    fog_free();
+    fov_clear();
+    spatial_free();
+    units_clear();
+    sprite_pool_clear();
+    intern_clear();
     path_cleanup();
-    if (g_terrain_map) { free(g_terrain_map); g_terrain_map = NULL; }
+    world_free();
     config_free();
     TTF_Quit();
     SDL_DestroyWindow(window);
@@ -9,8 +9,6 @@ extern "C" {
 
 /* Forward declarations of project types */
 typedef struct Sprite Sprite;
-typedef struct Skill Skill;
-typedef struct Item Item;
 
 /* Element enum reference (if present elsewhere); keep as int if unknown */
 typedef int Element;
@@ -18,6 +16,19 @@ typedef int Element;
 #define ELEM_FIRE 1
 #endif
 
+typedef struct Skill {
+    char *name;
+    int power;
+    int base_cast_ms;
+    Element elem;
+} Skill;
+
+typedef struct Item {
+    char *name;
+    int heal_hp;
+    int heal_mp;
+} Item;
+
 /* Action interfaces adapted to Sprite */
 int calc_physical_damage(const Sprite *atk, const Sprite *def, int weapon_power, int is_critical);
 int calc_magic_damage(const Sprite *atk, const Sprite *def, const Skill *spell);
@@ -0,0 +1,161 @@
+/* ai.c - turn planner for computer-controlled factions */
+#include <stdlib.h>
+#include <string.h>
+
+#include "action.h"
+#include "ai.h"
+#include "hex_utils.h"
+#include "job.h"
+#include "region.h"
+#include "spatial.h"
+#include "sprite.h"
+#include "timing.h"
+#include "world.h"
+
+#define AI_BOX (2 * AI_MAX_MOVE + 1)
+#define AI_KILL_BONUS 10000
+
+/* the spell magic users are assumed to cast when estimating damage */
+static const Skill s_ai_spell = { "Bolt", 0, 600, 0 };
+
+typedef struct { int row, col, steps; } AiCell;
+
+static int alive_enemy(int k, int faction) {
+    return g_units.faction[k] != faction && g_units.hp[k] > 0 && g_units.owner[k];
+}
+
+typedef struct { int faction, region; } EnemyFilter;
+
+static int accept_enemy(int dense, void *user) {
+    const EnemyFilter *f = user;
+    if (!alive_enemy(dense, f->faction)) return 0;
+    return f->region < 0 || region_label_at(g_units.x[dense], g_units.y[dense]) == f->region;
+}
+
+/* breadth-first over passable cells not held by another unit */
+static int reachable_cells(int k, AiCell *out) {
+    int row = g_units.x[k], col = g_units.y[k];
+    int move = g_units.move[k];
+    if (move > AI_MAX_MOVE) move = AI_MAX_MOVE;
+    if (move < 0) move = 0;
+    unsigned char seen[AI_BOX * AI_BOX];
+    memset(seen, 0, sizeof(seen));
+    int n = 0;
+    out[n++] = (AiCell){ row, col, 0 };
+    seen[AI_MAX_MOVE * AI_BOX + AI_MAX_MOVE] = 1;
+    for (int head = 0; head < n; ++head) {
+        if (out[head].steps >= move) continue;
+        int nr[6], nc[6];
+        int nn = get_neighbors(out[head].row, out[head].col, nr, nc);
+        for (int i = 0; i < nn; ++i) {
+            int bi = (nr[i] - row + AI_MAX_MOVE) * AI_BOX + (nc[i] - col + AI_MAX_MOVE);
+            if (seen[bi]) continue;
+            seen[bi] = 1;
+            if (path_terrain_cost(TERRAIN_AT(nr[i], nc[i])) >= PATH_IMPASSABLE_COST) continue;
+            if (spatial_unit_at(nr[i], nc[i]) != UNIT_NONE) continue;
+            out[n++] = (AiCell){ nr[i], nc[i], out[head].steps + 1 };
+        }
+    }
+    return n;
+}
+
+static int estimate_damage(const Sprite *atk, const Sprite *def, int mode) {
+    if (mode == ATTACK_MODE_MAGIC) return calc_magic_damage(atk, def, &s_ai_spell);
+    return calc_physical_damage(atk, def, 0, 0);
+}
+
+int ai_plan_unit(UnitId id, AiPlan *out, long *evaluated) {
+    int k = unit_index(id);
+    if (k < 0 || g_units.hp[k] <= 0 || !g_units.owner[k]) return 0;
+    const Sprite *self = g_units.owner[k];
+    int faction = g_units.faction[k];
+    int mode = job_attack_mode((JobType)g_units.job[k]);
+
+    AiCell cells[AI_BOX * AI_BOX];
+    int ncells = reachable_cells(k, cells);
+    long scored = 0;
+
+    out->unit = id;
+    out->row = g_units.x[k]; out->col = g_units.y[k];
+    out->target = UNIT_NONE;
+    out->mode = mode;
+    out->damage = 0;
+    out->score = 0;
+    int best = -1;
+
+    /* attack candidates: every enemy adjacent to a reachable cell */
+    for (int i = 0; i < ncells; ++i) {
+        UnitId near[8];
+        int n = spatial_query(cells[i].row, cells[i].col, 1, near, 8);
+        if (n > 8) n = 8;
+        for (int j = 0; j < n; ++j) {
+            int d = unit_index(near[j]);
+            if (d < 0 || !alive_enemy(d, faction)) continue;
+            int dmg = estimate_damage(self, g_units.owner[d], mode);
+            int score = dmg * 10 - cells[i].steps + (dmg >= g_units.hp[d] ? AI_KILL_BONUS : 0);
+            scored++;
+            if (score > best) {
+                best = score;
+                out->row = cells[i].row; out->col = cells[i].col;
+                out->target = near[j];
+                out->damage = dmg;
+                out->score = score;
+            }
+        }
+    }
+
+    /* nobody in reach: close in on the nearest enemy that can be walked to */
+    if (out->target == UNIT_NONE) {
+        EnemyFilter f = { faction, region_label_at(g_units.x[k], g_units.y[k]) };
+        int e = spatial_nearest(g_units.x[k], g_units.y[k], -1, accept_enemy, &f);
+        if (e >= 0) {
+            int er = g_units.x[e], ec = g_units.y[e];
+            best = -hex_distance_cells(out->row, out->col, er, ec) * 10;
+            for (int i = 1; i < ncells; ++i) {
+                int score = -hex_distance_cells(cells[i].row, cells[i].col, er, ec) * 10 - cells[i].steps;
+                scored++;
+                if (score > best) {
+                    best = score;
+                    out->row = cells[i].row; out->col = cells[i].col;
+                }
+            }
+            out->score = best;
+        }
+    }
+    if (evaluated) *evaluated += scored;
+    return 1;
+}
+
+void ai_begin_turn(AiPlanner *p, int faction) {
+    p->faction = faction;
+    p->count = p->next = 0;
+    if (g_units.count > p->cap) {
+        UnitId *q = realloc(p->queue, sizeof(UnitId) * g_units.count);
+        if (!q) return;
+        p->queue = q;
+        p->cap = g_units.count;
+    }
+    for (int k = 0; k < g_units.count; ++k) {
+        if (g_units.faction[k] == faction && g_units.hp[k] > 0) p->queue[p->count++] = g_units.id[k];
+    }
+}
+
+int ai_plan_step(AiPlanner *p, double budget_ms, AiApplyFn apply, void *user) {
+    if (p->next >= p->count) return 1;
+    double start = timing_now_ms();
+    p->slices++;
+    do {
+        AiPlan plan;
+        if (ai_plan_unit(p->queue[p->next++], &plan, &p->evaluated) && apply) apply(&plan, user);
+    } while (p->next < p->count && (budget_ms <= 0 || timing_now_ms() - start < budget_ms));
+    return p->next >= p->count;
+}
+
+int ai_pending(const AiPlanner *p) {
+    return p->next < p->count;
+}
+
+void ai_free(AiPlanner *p) {
+    free(p->queue);
+    memset(p, 0, sizeof(*p));
+}
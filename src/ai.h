@@ -0,0 +1,60 @@
+/* ai.h - turn planner for computer-controlled factions */
+#ifndef AI_H
+#define AI_H
+
+#include "units.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* planning time the game gives the AI per frame */
+#define AI_FRAME_BUDGET_MS 2.0
+/* move ranges above this are searched only this far */
+#define AI_MAX_MOVE 8
+
+/* What one unit does this turn: step to (row,col), then attack `target`
+ * (UNIT_NONE = no attack) with `mode`. */
+typedef struct {
+    UnitId unit;
+    int row, col;
+    UnitId target;
+    int mode;       /* AttackMode */
+    int damage;     /* estimated damage of the attack */
+    int score;
+} AiPlan;
+
+/* carry out a plan; called as soon as each unit is planned, so later units
+ * see the board after earlier ones moved */
+typedef void (*AiApplyFn)(const AiPlan *plan, void *user);
+
+/* One faction's turn, planned unit by unit across as many ai_plan_step
+ * calls as the time budget requires. */
+typedef struct {
+    int faction;
+    UnitId *queue;
+    int count, next, cap;
+    long evaluated;     /* candidate moves scored */
+    int slices;         /* ai_plan_step calls that did work */
+} AiPlanner;
+
+/* Score every cell `id` can reach this turn (up to its move range, over
+ * passable free cells) by the damage it could deal from there, estimated
+ * with calc_physical_damage/calc_magic_damage. With nobody in reach, the
+ * unit closes in on the nearest enemy in its region. Returns 0 for a dead
+ * or stale unit. `evaluated` (may be NULL) accumulates candidates scored. */
+int ai_plan_unit(UnitId id, AiPlan *out, long *evaluated);
+
+/* queue the living units of `faction` for a new turn */
+void ai_begin_turn(AiPlanner *p, int faction);
+/* Plan and apply queued units until `budget_ms` is spent (at least one
+ * unit per call; <= 0 = no limit). Returns 1 once the turn is finished. */
+int ai_plan_step(AiPlanner *p, double budget_ms, AiApplyFn apply, void *user);
+int ai_pending(const AiPlanner *p);
+void ai_free(AiPlanner *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AI_H */
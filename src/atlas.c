@@ -0,0 +1,208 @@
+/* atlas.c - named sprite-sheet regions with hashed lookup */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "atlas.h"
+
+/* Sidecar layout (native endianness; a mismatch just falls back to the text):
+ *   char magic[4] "ATL1", int32 count, int32 names_size,
+ *   count x { int32 x, y, w, h, frames, name_offset }, names_size bytes of
+ *   NUL-terminated names.
+ */
+#define ATLAS_MAGIC "ATL1"
+
+typedef struct {
+    AtlasEntry e;
+    int name_off; /* into s_names */
+} Slot;
+
+static Slot *s_slots = NULL;
+static int s_count = 0, s_cap = 0;
+static char *s_names = NULL;
+static int s_names_len = 0, s_names_cap = 0;
+static int *s_table = NULL; /* open addressing: entry index or -1 */
+static int s_table_size = 0;
+
+static uint32_t name_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) { h ^= (unsigned char)*s++; h *= 16777619u; }
+    return h;
+}
+
+static int rebuild_table(void) {
+    int size = 16;
+    while (size < s_count * 2) size <<= 1;
+    int *table = malloc(sizeof(int) * size);
+    if (!table) return -1;
+    for (int i = 0; i < size; ++i) table[i] = -1;
+    /* newest first, so a repeated name resolves to its last definition */
+    for (int i = s_count - 1; i >= 0; --i) {
+        const char *name = s_names + s_slots[i].name_off;
+        uint32_t h = name_hash(name) & (size - 1);
+        while (table[h] >= 0 && strcmp(s_names + s_slots[table[h]].name_off, name) != 0) h = (h + 1) & (size - 1);
+        if (table[h] < 0) table[h] = i;
+    }
+    free(s_table);
+    s_table = table;
+    s_table_size = size;
+    return 0;
+}
+
+static int add_entry(const char *name, int x, int y, int w, int h, int frames) {
+    if (s_count == s_cap) {
+        int cap = s_cap ? s_cap * 2 : 64;
+        Slot *grown = realloc(s_slots, sizeof(Slot) * cap);
+        if (!grown) return -1;
+        s_slots = grown; s_cap = cap;
+    }
+    int len = (int)strlen(name) + 1;
+    if (s_names_len + len > s_names_cap) {
+        int cap = s_names_cap ? s_names_cap * 2 : 4096;
+        while (cap < s_names_len + len) cap *= 2;
+        char *grown = realloc(s_names, cap);
+        if (!grown) return -1;
+        s_names = grown; s_names_cap = cap;
+    }
+    memcpy(s_names + s_names_len, name, len);
+    Slot *s = &s_slots[s_count++];
+    s->e.x = x; s->e.y = y; s->e.w = w; s->e.h = h; s->e.frames = frames;
+    s->name_off = s_names_len;
+    s_names_len += len;
+    return 0;
+}
+
+void atlas_free(void) {
+    free(s_slots); s_slots = NULL; s_count = s_cap = 0;
+    free(s_names); s_names = NULL; s_names_len = s_names_cap = 0;
+    free(s_table); s_table = NULL; s_table_size = 0;
+}
+
+int atlas_load_text(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    atlas_free();
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char name[256];
+        int x, y, w, h, frames = 1;
+        int n = sscanf(line, "%255s %d %d %d %d %d", name, &x, &y, &w, &h, &frames);
+        if (n < 5) continue; /* blank or malformed line */
+        if (frames < 1) frames = 1;
+        if (add_entry(name, x, y, w, h, frames) != 0) { fclose(f); atlas_free(); return -1; }
+    }
+    fclose(f);
+    if (rebuild_table() != 0) { atlas_free(); return -1; }
+    return s_count;
+}
+
+int atlas_write_binary(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+    int32_t header[2] = { s_count, s_names_len };
+    int ok = fwrite(ATLAS_MAGIC, 1, 4, f) == 4 && fwrite(header, sizeof(header), 1, f) == 1;
+    for (int i = 0; ok && i < s_count; ++i) {
+        const Slot *s = &s_slots[i];
+        int32_t rec[6] = { s->e.x, s->e.y, s->e.w, s->e.h, s->e.frames, s->name_off };
+        ok = fwrite(rec, sizeof(rec), 1, f) == 1;
+    }
+    if (ok && s_names_len > 0) ok = fwrite(s_names, 1, s_names_len, f) == (size_t)s_names_len;
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) remove(path);
+    return ok ? 0 : -1;
+}
+
+int atlas_load_binary(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    char magic[4];
+    int32_t header[2];
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, ATLAS_MAGIC, 4) != 0 ||
+        fread(header, sizeof(header), 1, f) != 1 || header[0] < 0 || header[1] < 0) {
+        fclose(f);
+        return -1;
+    }
+    atlas_free();
+    int count = header[0], names_len = header[1];
+    s_slots = malloc(sizeof(Slot) * (count > 0 ? count : 1));
+    s_names = malloc(names_len > 0 ? names_len : 1);
+    int ok = s_slots && s_names;
+    for (int i = 0; ok && i < count; ++i) {
+        int32_t rec[6];
+        ok = fread(rec, sizeof(rec), 1, f) == 1 && rec[5] >= 0 && rec[5] < names_len;
+        if (!ok) break;
+        Slot *s = &s_slots[i];
+        s->e.x = rec[0]; s->e.y = rec[1]; s->e.w = rec[2]; s->e.h = rec[3];
+        s->e.frames = rec[4] > 0 ? rec[4] : 1;
+        s->name_off = rec[5];
+    }
+    if (ok && names_len > 0) ok = fread(s_names, 1, names_len, f) == (size_t)names_len;
+    /* names must be terminated inside the blob */
+    if (ok && names_len > 0) ok = s_names[names_len - 1] == '\0';
+    fclose(f);
+    if (!ok) { atlas_free(); return -1; }
+    s_count = s_cap = count;
+    s_names_len = s_names_cap = names_len;
+    if (rebuild_table() != 0) { atlas_free(); return -1; }
+    return s_count;
+}
+
+int atlas_load(const char *path) {
+    char sidecar[1024];
+    if (snprintf(sidecar, sizeof(sidecar), "%s.bin", path) >= (int)sizeof(sidecar)) return atlas_load_text(path);
+    struct stat text_st, bin_st;
+    int have_text = stat(path, &text_st) == 0;
+    int have_bin = stat(sidecar, &bin_st) == 0;
+    if (have_bin && (!have_text || bin_st.st_mtime >= text_st.st_mtime)) {
+        int n = atlas_load_binary(sidecar);
+        if (n >= 0) return n;
+    }
+    int n = atlas_load_text(path);
+    /* best effort: a read-only resource directory just means no fast path */
+    if (n >= 0) atlas_write_binary(sidecar);
+    return n;
+}
+
+AtlasFrameId atlas_find(const char *name) {
+    if (!name || !s_table) return ATLAS_NONE;
+    uint32_t h = name_hash(name) & (s_table_size - 1);
+    while (s_table[h] >= 0) {
+        int i = s_table[h];
+        if (strcmp(s_names + s_slots[i].name_off, name) == 0) return i;
+        h = (h + 1) & (s_table_size - 1);
+    }
+    return ATLAS_NONE;
+}
+
+AtlasFrameId atlas_find_anim(const char *base, const char *action) {
+    char name[256];
+    if (!base || !base[0] || !action) return ATLAS_NONE;
+    if (snprintf(name, sizeof(name), "%s_%s_anim", base, action) >= (int)sizeof(name)) return ATLAS_NONE;
+    return atlas_find(name);
+}
+
+int atlas_count(void) {
+    return s_count;
+}
+
+const AtlasEntry *atlas_entry(AtlasFrameId id) {
+    return (id >= 0 && id < s_count) ? &s_slots[id].e : NULL;
+}
+
+const char *atlas_name(AtlasFrameId id) {
+    return (id >= 0 && id < s_count) ? s_names + s_slots[id].name_off : NULL;
+}
+
+int atlas_frame_rect(AtlasFrameId id, int frame, int *x, int *y, int *w, int *h) {
+    const AtlasEntry *e = atlas_entry(id);
+    if (!e) return 0;
+    if (frame < 0) frame = 0;
+    frame %= e->frames;
+    *x = e->x + frame * e->w;
+    *y = e->y;
+    *w = e->w;
+    *h = e->h;
+    return 1;
+}
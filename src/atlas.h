@@ -0,0 +1,53 @@
+/* atlas.h - named sprite-sheet regions with hashed lookup */
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Handle of an atlas entry; stable until the next atlas_load/atlas_free */
+typedef int AtlasFrameId;
+#define ATLAS_NONE (-1)
+
+/* One named region. Animated entries hold `frames` equally sized frames laid
+ * out left to right starting at (x,y).
+ */
+typedef struct {
+    int x, y, w, h;
+    int frames;
+} AtlasEntry;
+
+/* Load an atlas description ("name x y w h [frames]" per line). A binary
+ * sidecar `<path>.bin` is used instead when it is at least as new as the
+ * text file, and is (re)written after parsing the text otherwise. Replaces
+ * any previously loaded atlas. Returns the entry count, or -1 on failure.
+ */
+int atlas_load(const char *path);
+
+/* parse the text format only / read or write the binary sidecar only */
+int atlas_load_text(const char *path);
+int atlas_load_binary(const char *path);
+int atlas_write_binary(const char *path);
+
+/* id of entry `name`, or ATLAS_NONE */
+AtlasFrameId atlas_find(const char *name);
+
+/* id of "<base>_<action>_anim" (e.g. "knight_f", "run"), or ATLAS_NONE */
+AtlasFrameId atlas_find_anim(const char *base, const char *action);
+
+int atlas_count(void);
+const AtlasEntry *atlas_entry(AtlasFrameId id);
+const char *atlas_name(AtlasFrameId id);
+
+/* source rectangle of frame `frame` (wrapped to the entry's frame count);
+ * returns 0 for an invalid id */
+int atlas_frame_rect(AtlasFrameId id, int frame, int *x, int *y, int *w, int *h);
+
+void atlas_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ATLAS_H */
@@ -0,0 +1,126 @@
+/* battlesim.c - Monte Carlo estimate of one-on-one battle outcomes */
+#include <stdlib.h>
+#include <string.h>
+
+#include "battlesim.h"
+
+#define CHUNK_TRIALS 1024
+
+typedef struct {
+    const SimUnit *a, *b;
+    int trials;
+    uint64_t seed;
+    BattleOutcome *chunks;      /* one partial result per chunk */
+    long *hp_sum;               /* 2 per chunk: HP left for a, b */
+    long *round_sum;            /* per chunk, over decided trials */
+} SimJob;
+
+/* `atk` hits `def` once; returns 1 if the defender fell */
+static int strike(SimUnit *atk, SimUnit *def, Rng *rng) {
+    CombatStats st = { atk->attack, atk->level, atk->mp, def->defense, def->hp, def->max_hp };
+    int mp_cost = 0;
+    int damage = combat_eval(combat_rule(atk->job, atk->attack_mode), &st, rng, &mp_cost);
+    atk->mp -= mp_cost;
+    def->hp = damage >= def->hp ? 0 : def->hp - damage;
+    return def->hp == 0;
+}
+
+static int hp_bucket(const SimUnit *u) {
+    if (u->max_hp <= 0 || u->hp <= 0) return -1;
+    int k = (int)((long)(u->hp - 1) * BATTLESIM_HP_BUCKETS / u->max_hp);
+    return k < 0 ? 0 : k >= BATTLESIM_HP_BUCKETS ? BATTLESIM_HP_BUCKETS - 1 : k;
+}
+
+static void run_chunk(void *ctx, int chunk, int worker) {
+    (void)worker;
+    SimJob *job = ctx;
+    BattleOutcome *o = &job->chunks[chunk];
+    memset(o, 0, sizeof(*o));
+    Rng rng;
+    rng_seed(&rng, job->seed, (uint64_t)chunk);
+    int first = chunk * CHUNK_TRIALS;
+    int n = job->trials - first < CHUNK_TRIALS ? job->trials - first : CHUNK_TRIALS;
+    long hp_a = 0, hp_b = 0, rounds_total = 0;
+    int a_first = job->a->speed >= job->b->speed;
+    for (int t = 0; t < n; ++t) {
+        SimUnit a = *job->a, b = *job->b;
+        SimUnit *p = a_first ? &a : &b, *q = a_first ? &b : &a;
+        int round = 0, over = 0;
+        while (!over && round < BATTLESIM_MAX_ROUNDS) {
+            ++round;
+            over = strike(p, q, &rng) || strike(q, p, &rng);
+        }
+        if (a.hp > 0 && b.hp == 0) o->wins_a++;
+        else if (b.hp > 0 && a.hp == 0) o->wins_b++;
+        else o->draws++;
+        if (over) { o->rounds_hist[round]++; rounds_total += round; }
+        int ka = hp_bucket(&a), kb = hp_bucket(&b);
+        if (ka >= 0) o->hp_hist_a[ka]++;
+        if (kb >= 0) o->hp_hist_b[kb]++;
+        hp_a += a.hp;
+        hp_b += b.hp;
+    }
+    o->trials = n;
+    job->hp_sum[chunk * 2] = hp_a;
+    job->hp_sum[chunk * 2 + 1] = hp_b;
+    job->round_sum[chunk] = rounds_total;
+}
+
+void battlesim_unit_from_sprite(const Sprite *s, SimUnit *out) {
+    memset(out, 0, sizeof(*out));
+    if (!s) return;
+    int u = unit_index(s->unit);
+    if (u < 0) return;
+    out->job = (JobType)g_units.job[u];
+    out->attack_mode = job_attack_mode(out->job);
+    out->attack = g_units.attack[u];
+    out->defense = g_units.defense[u];
+    out->level = g_units.level[u];
+    out->speed = g_units.speed[u];
+    out->hp = g_units.hp[u];
+    out->max_hp = g_units.max_hp[u];
+    out->mp = g_units.mp[u];
+}
+
+void battlesim_estimate(const SimUnit *a, const SimUnit *b, int trials, uint64_t seed,
+                        ThreadPool *pool, BattleOutcome *out) {
+    memset(out, 0, sizeof(*out));
+    if (!a || !b || trials <= 0) return;
+    int nchunks = (trials + CHUNK_TRIALS - 1) / CHUNK_TRIALS;
+    SimJob job = { a, b, trials, seed, NULL, NULL, NULL };
+    job.chunks = malloc(sizeof(BattleOutcome) * nchunks);
+    job.hp_sum = malloc(sizeof(long) * nchunks * 2);
+    job.round_sum = malloc(sizeof(long) * nchunks);
+    if (!job.chunks || !job.hp_sum || !job.round_sum) {
+        free(job.chunks); free(job.hp_sum); free(job.round_sum);
+        return;
+    }
+    (void)combat_rule(a->job, a->attack_mode); /* the table initializes lazily; not from workers */
+    threadpool_run(pool, run_chunk, &job, nchunks);
+
+    /* integer sums, so the merge order does not matter */
+    long hp_a = 0, hp_b = 0, rounds_total = 0;
+    for (int c = 0; c < nchunks; ++c) {
+        const BattleOutcome *o = &job.chunks[c];
+        out->trials += o->trials;
+        out->wins_a += o->wins_a;
+        out->wins_b += o->wins_b;
+        out->draws += o->draws;
+        for (int r = 0; r <= BATTLESIM_MAX_ROUNDS; ++r) out->rounds_hist[r] += o->rounds_hist[r];
+        for (int k = 0; k < BATTLESIM_HP_BUCKETS; ++k) {
+            out->hp_hist_a[k] += o->hp_hist_a[k];
+            out->hp_hist_b[k] += o->hp_hist_b[k];
+        }
+        hp_a += job.hp_sum[c * 2];
+        hp_b += job.hp_sum[c * 2 + 1];
+        rounds_total += job.round_sum[c];
+    }
+    int decided = out->wins_a + out->wins_b;
+    out->win_rate_a = (double)out->wins_a / out->trials;
+    out->mean_rounds = decided > 0 ? (double)rounds_total / decided : 0.0;
+    out->mean_hp_a = (double)hp_a / out->trials;
+    out->mean_hp_b = (double)hp_b / out->trials;
+    free(job.chunks);
+    free(job.hp_sum);
+    free(job.round_sum);
+}
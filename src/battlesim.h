@@ -0,0 +1,52 @@
+/* battlesim.h - Monte Carlo estimate of one-on-one battle outcomes */
+#ifndef BATTLESIM_H
+#define BATTLESIM_H
+
+#include <stdint.h>
+
+#include "combat.h"
+#include "sprite.h"
+#include "threadpool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BATTLESIM_MAX_ROUNDS 100   /* a trial still undecided after this is a draw */
+#define BATTLESIM_HP_BUCKETS 10    /* remaining-HP histogram: 10% of max HP per bucket */
+
+/* the stats a trial fights with */
+typedef struct {
+    JobType job;
+    int attack_mode;    /* AttackMode */
+    int attack, defense, level, speed;
+    int hp, max_hp, mp;
+} SimUnit;
+
+typedef struct {
+    int trials;
+    int wins_a, wins_b, draws;
+    double win_rate_a;          /* wins_a / trials */
+    double mean_rounds;         /* rounds until a unit fell, over decided trials */
+    int rounds_hist[BATTLESIM_MAX_ROUNDS + 1];  /* decided trials by round count */
+    double mean_hp_a, mean_hp_b;                /* HP left at the end, over all trials */
+    int hp_hist_a[BATTLESIM_HP_BUCKETS];        /* survivor HP left; bucket k holds (k, k+1] tenths */
+    int hp_hist_b[BATTLESIM_HP_BUCKETS];
+} BattleOutcome;
+
+void battlesim_unit_from_sprite(const Sprite *s, SimUnit *out);
+
+/* Fight `trials` independent duels of `a` against `b` and summarize them.
+ * Each round the faster unit (a on ties) attacks first, using combat_eval,
+ * and the other answers if still standing; MP costs are paid as in
+ * sprite_attack. Trials are split into fixed-size chunks run on `pool`
+ * (NULL = the calling thread); every chunk draws from its own Rng stream
+ * derived from `seed`, so results do not depend on the thread count. */
+void battlesim_estimate(const SimUnit *a, const SimUnit *b, int trials, uint64_t seed,
+                        ThreadPool *pool, BattleOutcome *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BATTLESIM_H */
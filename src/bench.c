@@ -0,0 +1,308 @@
+/* bench.c - micro-benchmarks for core algorithms
+ *
+ * Usage: 2048civ_bench [--json] [--quick]
+ * Prints one record per benchmark as CSV (default) or a JSON array. All
+ * inputs use fixed seeds so numbers are comparable across builds.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "battlesim.h"
+#include "combatbatch.h"
+#include "config.h"
+#include "fov.h"
+#include "hex_utils.h"
+#include "intern.h"
+#include "job.h"
+#include "path.h"
+#include "perlin.h"
+#include "rng.h"
+#include "sprite.h"
+#include "textwrap.h"
+#include "timing.h"
+#include "world.h"
+
+#define BENCH_SEED 12345u
+#define MAX_RESULTS 64
+
+typedef struct {
+    const char *name;
+    int size;        /* map edge length, 0 when not applicable */
+    long iterations;
+    double total_ms;
+} BenchResult;
+
+static BenchResult s_results[MAX_RESULTS];
+static int s_result_count = 0;
+static volatile long s_sink; /* keeps results of timed loops alive */
+
+static void record(const char *name, int size, long iterations, double total_ms) {
+    if (s_result_count >= MAX_RESULTS) return;
+    BenchResult *r = &s_results[s_result_count++];
+    r->name = name;
+    r->size = size;
+    r->iterations = iterations;
+    r->total_ms = total_ms;
+}
+
+static double ns_per_op(const BenchResult *r) {
+    return r->iterations > 0 ? r->total_ms * 1e6 / r->iterations : 0.0;
+}
+
+static void init_noise(void) {
+    PerlinParams pp;
+    config_get_perlin_params(&pp);
+    pp.seed = BENCH_SEED;
+    perlin_init_with_params(&pp);
+    rng_init_streams(BENCH_SEED);
+}
+
+static void bench_perlin(long samples) {
+    int side = 1024;
+    float acc = 0.0f;
+    double t0 = timing_now_ms();
+    for (long i = 0; i < samples; ++i) acc += perlin_elevation((float)(i % side), (float)(i / side));
+    record("perlin_elevation", 0, samples, timing_now_ms() - t0);
+    t0 = timing_now_ms();
+    for (long i = 0; i < samples; ++i) acc += perlin_moisture((float)(i % side), (float)(i / side));
+    record("perlin_moisture", 0, samples, timing_now_ms() - t0);
+    s_sink += (long)acc;
+}
+
+static void bench_worldgen(int size) {
+    double t0 = timing_now_ms();
+    world_generate(size, size);
+    record("world_generate_cell", size, (long)size * size, timing_now_ms() - t0);
+}
+
+/* expects the world of `size` to be generated already */
+static void bench_paths(int size, int queries) {
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED, (uint64_t)size);
+    int found = 0;
+    path_cleanup(); /* buffers are sized per map */
+    double t0 = timing_now_ms();
+    for (int i = 0; i < queries; ++i) {
+        int sr = rng_range(&rng, size), sc = rng_range(&rng, size);
+        int tr = rng_range(&rng, size), tc = rng_range(&rng, size);
+        compute_path(sr, sc, tr, tc);
+        if (path_len > 0) found++;
+    }
+    record("compute_path", size, queries, timing_now_ms() - t0);
+    s_sink += found;
+}
+
+/* shadowcast views from random cells of the current world */
+static void bench_fov(int size, int radius, int views) {
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED, 2);
+    static FovMask m;
+    long acc = 0;
+    double t0 = timing_now_ms();
+    for (int i = 0; i < views; ++i) {
+        fov_compute(rng_range(&rng, size), rng_range(&rng, size), radius, &m);
+        acc += (long)m.mask[radius];
+    }
+    record("fov_compute", size, views, timing_now_ms() - t0);
+    s_sink += acc;
+}
+
+static void bench_hex_distance(long calls) {
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED, 1);
+    enum { N = 4096 };
+    static int cells[N][4];
+    for (int i = 0; i < N; ++i)
+        for (int k = 0; k < 4; ++k) cells[i][k] = rng_range(&rng, 4096);
+    long acc = 0;
+    double t0 = timing_now_ms();
+    for (long i = 0; i < calls; ++i) {
+        const int *c = cells[i & (N - 1)];
+        acc += hex_distance_cells(c[0], c[1], c[2], c[3]);
+    }
+    record("hex_distance_cells", 0, calls, timing_now_ms() - t0);
+    s_sink += acc;
+}
+
+/* distances from one center to a block of cells, per cell */
+static void bench_hex_distance_batch(long cells_total) {
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED, 1);
+    enum { N = 4096 };
+    static int rows[N], cols[N], out[N];
+    for (int i = 0; i < N; ++i) { rows[i] = rng_range(&rng, 4096); cols[i] = rng_range(&rng, 4096); }
+    long rounds = cells_total / N + 1, acc = 0;
+    double t0 = timing_now_ms();
+    for (long i = 0; i < rounds; ++i) {
+        hex_distance_batch((int)(i & 4095), 2048, rows, cols, N, out);
+        acc += out[i & (N - 1)];
+    }
+    record("hex_distance_batch", 0, rounds * N, timing_now_ms() - t0);
+    s_sink += acc;
+}
+
+static void bench_attack(long attacks) {
+    static const char *jobs[] = { "Warrior", "Mage", "Rogue", "Cleric", "Archer" };
+    Sprite *atk[5], *def = sprite_create("Target", "Warrior", NULL, 10);
+    for (int j = 0; j < 5; ++j) atk[j] = sprite_create("Attacker", jobs[j], NULL, 10);
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED, RNG_STREAM_COMBAT);
+    long total = 0;
+    double t0 = timing_now_ms();
+    for (long i = 0; i < attacks; ++i) {
+        Sprite *a = atk[i % 5];
+        total += sprite_attack_rng(a, def, job_attack_mode((JobType)SPRITE_FIELD(a, job)), &rng);
+        SPRITE_FIELD(def, hp) = SPRITE_FIELD(def, max_hp);
+        SPRITE_FIELD(a, mp) = SPRITE_FIELD(a, max_mp);
+    }
+    record("sprite_attack", 0, attacks, timing_now_ms() - t0);
+    s_sink += total;
+    for (int j = 0; j < 5; ++j) sprite_destroy(atk[j]);
+    sprite_destroy(def);
+}
+
+/* the same attacks as bench_attack, resolved `wave` at a time by the batch resolver */
+static void bench_combat_batch(long attacks, int wave) {
+    static const char *jobs[] = { "Warrior", "Mage", "Rogue", "Cleric", "Archer" };
+    Sprite *atk[5], *def = sprite_create("Target", "Warrior", NULL, 10);
+    for (int j = 0; j < 5; ++j) atk[j] = sprite_create("Attacker", jobs[j], NULL, 10);
+    CombatBatch batch = {0};
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED, RNG_STREAM_COMBAT);
+    long total = 0, done = 0;
+    double t0 = timing_now_ms();
+    while (done < attacks) {
+        for (int i = 0; i < wave && done < attacks; ++i, ++done) {
+            Sprite *a = atk[done % 5];
+            combat_batch_add(&batch, a->unit, def->unit, job_attack_mode((JobType)SPRITE_FIELD(a, job)));
+        }
+        total += combat_batch_resolve(&batch, &rng);
+        SPRITE_FIELD(def, hp) = SPRITE_FIELD(def, max_hp);
+        for (int j = 0; j < 5; ++j) SPRITE_FIELD(atk[j], mp) = SPRITE_FIELD(atk[j], max_mp);
+    }
+    record("combat_batch", 0, attacks, timing_now_ms() - t0);
+    s_sink += total;
+    combat_batch_free(&batch);
+    for (int j = 0; j < 5; ++j) sprite_destroy(atk[j]);
+    sprite_destroy(def);
+}
+
+/* Monte Carlo duels, warrior against mage, on every CPU */
+static void bench_battlesim(int trials) {
+    Sprite *a = sprite_create("A", "Warrior", NULL, 10), *b = sprite_create("B", "Mage", NULL, 10);
+    SimUnit sa, sb;
+    battlesim_unit_from_sprite(a, &sa);
+    battlesim_unit_from_sprite(b, &sb);
+    ThreadPool *pool = threadpool_create(0);
+    BattleOutcome o;
+    double t0 = timing_now_ms();
+    battlesim_estimate(&sa, &sb, trials, BENCH_SEED, pool, &o);
+    record("battlesim", 0, trials, timing_now_ms() - t0);
+    s_sink += o.wins_a;
+    threadpool_destroy(pool);
+    sprite_destroy(a);
+    sprite_destroy(b);
+}
+
+/* spawn and despawn a wave of `wave` sprites `rounds` times */
+static void bench_spawn(int wave, int rounds) {
+    static const char *jobs[] = { "Warrior", "Mage", "Rogue", "Cleric", "Archer" };
+    Sprite **live = malloc(sizeof(Sprite *) * wave);
+    if (!live) return;
+    char name[32];
+    double t0 = timing_now_ms();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < wave; ++i) {
+            snprintf(name, sizeof(name), "Unit%d", i);
+            live[i] = sprite_create(name, jobs[i % 5], "knight_f", 1 + i % 10);
+        }
+        for (int i = 0; i < wave; ++i) sprite_destroy(live[i]);
+    }
+    record("sprite_spawn", 0, (long)wave * rounds, timing_now_ms() - t0);
+    free(live);
+}
+
+/* fixed advances stand in for a font: 7 px ASCII, 14 px everything else */
+static int bench_glyph_advance(void *user, uint32_t cp) {
+    (void)user;
+    return cp < 128 ? 7 : 14;
+}
+
+/* wrap a long mixed English/Chinese combat log; iterations are bytes */
+static void bench_textwrap(int repeats) {
+    static const char *entry = "Warrior hits Goblin for 12 physical damage. 战士攻击哥布林，造成12点物理伤害。\n";
+    size_t entry_len = strlen(entry);
+    char *log = malloc(entry_len * 1000 + 1);
+    if (!log) return;
+    for (int i = 0; i < 1000; ++i) memcpy(log + i * entry_len, entry, entry_len);
+    log[entry_len * 1000] = '\0';
+    GlyphCache gc;
+    glyph_cache_init(&gc, bench_glyph_advance, NULL);
+    TextSpan spans[64];
+    long lines = 0;
+    double t0 = timing_now_ms();
+    for (int r = 0; r < repeats; ++r) lines += textwrap(&gc, log, 200, spans, 64);
+    record("textwrap", 0, (long)repeats * (long)(entry_len * 1000), timing_now_ms() - t0);
+    s_sink += lines;
+    free(log);
+}
+
+static void print_csv(void) {
+    printf("name,size,iterations,total_ms,ns_per_op\n");
+    for (int i = 0; i < s_result_count; ++i) {
+        const BenchResult *r = &s_results[i];
+        printf("%s,%d,%ld,%.3f,%.1f\n", r->name, r->size, r->iterations, r->total_ms, ns_per_op(r));
+    }
+}
+
+static void print_json(void) {
+    printf("[\n");
+    for (int i = 0; i < s_result_count; ++i) {
+        const BenchResult *r = &s_results[i];
+        printf("  {\"name\": \"%s\", \"size\": %d, \"iterations\": %ld, \"total_ms\": %.3f, \"ns_per_op\": %.1f}%s\n",
+               r->name, r->size, r->iterations, r->total_ms, ns_per_op(r), i + 1 < s_result_count ? "," : "");
+    }
+    printf("]\n");
+}
+
+int main(int argc, char* argv[]) {
+    int json = 0, quick = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0) json = 1;
+        else if (strcmp(argv[i], "--quick") == 0) quick = 1;
+        else {
+            fprintf(stderr, "usage: %s [--json] [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+    const int sizes[] = { 64, 256, 1024 };
+    int nsizes = quick ? 2 : 3;
+    long scale = quick ? 10 : 1;
+
+    config_init();
+    init_noise();
+    bench_perlin(2000000 / scale);
+    for (int i = 0; i < nsizes; ++i) {
+        bench_worldgen(sizes[i]);
+        bench_paths(sizes[i], (int)(200 / scale) + 1);
+    }
+    bench_fov(sizes[nsizes - 1], 8, (int)(200000 / scale));
+    bench_hex_distance(20000000 / scale);
+    bench_hex_distance_batch(20000000 / scale);
+    bench_attack(5000000 / scale);
+    bench_combat_batch(5000000 / scale, 4096);
+    bench_battlesim((int)(1000000 / scale));
+    bench_spawn(4096, (int)(200 / scale));
+    bench_textwrap((int)(200 / scale));
+
+    if (json) print_json(); else print_csv();
+
+    units_clear();
+    sprite_pool_clear();
+    intern_clear();
+    path_cleanup();
+    world_free();
+    config_free();
+    return 0;
+}
@@ -0,0 +1,161 @@
+/* combat.c - data-driven combat rules */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "combat.h"
+
+static CombatRule s_rules[JOB_COUNT][ATTACK_MODE_COUNT];
+static ActionRule s_action;
+static int s_ready = 0;
+
+static const char *s_mode_names[ATTACK_MODE_COUNT] = { "none", "physical", "magic" };
+
+void combat_rules_defaults(void) {
+    /* mirrors res/rules/combat */
+    CombatRule phys = { 1.0, 1.0, 0.0, 0.0, 0, 0, 2.0, 0, 0.3, 2, 0.10, 0, 0 };
+    CombatRule magic = { 1.0, 0.0, 0.5, 0.0, 0, 0, 2.0, 0, 0.3, 3, 0.15, 5, 5 };
+    for (int j = 0; j < JOB_COUNT; ++j) {
+        s_rules[j][ATTACK_MODE_PHYSICAL] = phys;
+        s_rules[j][ATTACK_MODE_MAGIC] = magic;
+    }
+    s_rules[JOB_WARRIOR][ATTACK_MODE_PHYSICAL].job_bonus = 0.2;  // 战士额外20%伤害
+    s_rules[JOB_ROGUE][ATTACK_MODE_PHYSICAL].crit_pct = 30;      // 盗贼30%暴击几率
+    s_rules[JOB_ARCHER][ATTACK_MODE_PHYSICAL].flat = 5;          // 弓箭手固定加成
+    s_rules[JOB_MAGE][ATTACK_MODE_MAGIC].job_bonus = 0.3;        // 法师额外30%魔法伤害
+    s_rules[JOB_CLERIC][ATTACK_MODE_MAGIC].low_hp_bonus = 10;    // 牧师对低血量目标额外伤害
+    for (int j = 0; j < JOB_COUNT; ++j) s_rules[j][ATTACK_MODE_NONE] = s_rules[j][ATTACK_MODE_PHYSICAL];
+    s_action.attack_mul = 2.0;
+    s_action.defense_mul = 0.5;
+    s_action.crit_mult = 1.5;
+    s_ready = 1;
+}
+
+static int set_rule_key(CombatRule *r, const char *key, double v) {
+    if (strcmp(key, "attack") == 0) r->attack_mul = v;
+    else if (strcmp(key, "defense") == 0) r->defense_mul = v;
+    else if (strcmp(key, "mp") == 0) r->mp_mul = v;
+    else if (strcmp(key, "job_bonus") == 0) r->job_bonus = v;
+    else if (strcmp(key, "flat") == 0) r->flat = (int)v;
+    else if (strcmp(key, "crit_chance") == 0) r->crit_pct = (int)v;
+    else if (strcmp(key, "crit_mult") == 0) r->crit_mult = v;
+    else if (strcmp(key, "low_hp_bonus") == 0) r->low_hp_bonus = (int)v;
+    else if (strcmp(key, "low_hp_frac") == 0) r->low_hp_frac = v;
+    else if (strcmp(key, "level") == 0) r->level_mul = (int)v;
+    else if (strcmp(key, "variance") == 0) r->variance = v;
+    else if (strcmp(key, "mp_cost_div") == 0) r->mp_cost_div = (int)v;
+    else if (strcmp(key, "mp_cost_base") == 0) r->mp_cost_base = (int)v;
+    else return 0;
+    return 1;
+}
+
+static int set_action_key(const char *key, double v) {
+    if (strcmp(key, "attack") == 0) s_action.attack_mul = v;
+    else if (strcmp(key, "defense") == 0) s_action.defense_mul = v;
+    else if (strcmp(key, "crit_mult") == 0) s_action.crit_mult = v;
+    else return 0;
+    return 1;
+}
+
+static int find_mode(const char *name) {
+    for (int m = ATTACK_MODE_PHYSICAL; m < ATTACK_MODE_COUNT; ++m)
+        if (strcasecmp(name, s_mode_names[m]) == 0) return m;
+    return -1;
+}
+
+static int find_job(const char *name) {
+    for (int j = 0; j < JOB_COUNT; ++j)
+        if (strcasecmp(name, job_info((JobType)j)->name) == 0) return j;
+    return -1;
+}
+
+/* Apply one "a.b[.c] = v" line. Pass 0 takes mode-wide and action lines,
+ * pass 1 per-job lines, so job overrides win regardless of file order. */
+static int apply_line(const char *line, int pass, const char *path, int lineno) {
+    char lhs[128];
+    double v;
+    if (sscanf(line, " %127[^= \t] = %lf", lhs, &v) != 2) return 0;
+    char *parts[3] = { lhs, NULL, NULL };
+    int n = 1;
+    for (char *p = lhs; *p && n < 3; ++p) {
+        if (*p == '.') { *p = '\0'; parts[n++] = p + 1; }
+    }
+    int j, m;
+    if (n == 2 && strcmp(parts[0], "action") == 0) {
+        if (pass != 0) return 0;
+        if (set_action_key(parts[1], v)) return 1;
+    } else if (n == 2 && (m = find_mode(parts[0])) >= 0) {
+        if (pass != 0) return 0;
+        int ok = 1;
+        for (j = 0; j < JOB_COUNT; ++j) ok = set_rule_key(&s_rules[j][m], parts[1], v);
+        if (ok) return 1;
+    } else if (n == 3 && (j = find_job(parts[0])) >= 0 && (m = find_mode(parts[1])) >= 0) {
+        if (pass != 1) return 0;
+        if (set_rule_key(&s_rules[j][m], parts[2], v)) return 1;
+    } else if (pass != 0) {
+        return 0;
+    }
+    fprintf(stderr, "%s:%d: unknown combat rule\n", path, lineno);
+    return 0;
+}
+
+int combat_rules_load(const char *path) {
+    combat_rules_defaults();
+    FILE *f = path ? fopen(path, "r") : NULL;
+    if (!f) return -1;
+    int applied = 0;
+    char line[256];
+    for (int pass = 0; pass < 2; ++pass) {
+        rewind(f);
+        int lineno = 0;
+        while (fgets(line, sizeof(line), f)) {
+            ++lineno;
+            char *hash = strchr(line, '#');
+            if (hash) *hash = '\0';
+            applied += apply_line(line, pass, path, lineno);
+        }
+    }
+    fclose(f);
+    for (int j = 0; j < JOB_COUNT; ++j) s_rules[j][ATTACK_MODE_NONE] = s_rules[j][ATTACK_MODE_PHYSICAL];
+    return applied;
+}
+
+const CombatRule *combat_rule(JobType job, int attack_mode) {
+    if (!s_ready) combat_rules_defaults();
+    if ((int)job < 0 || job >= JOB_COUNT) job = JOB_WARRIOR;
+    if (attack_mode < 0 || attack_mode >= ATTACK_MODE_COUNT) attack_mode = ATTACK_MODE_PHYSICAL;
+    return &s_rules[job][attack_mode];
+}
+
+const ActionRule *combat_action_rule(void) {
+    if (!s_ready) combat_rules_defaults();
+    return &s_action;
+}
+
+int combat_eval(const CombatRule *r, const CombatStats *st, Rng *rng, int *mp_cost) {
+    int damage = st->attack * r->attack_mul + st->mp * r->mp_mul - st->defense * r->defense_mul;
+    damage += st->attack * r->job_bonus;
+    damage += r->flat;
+    if (r->crit_pct > 0 && rng_range(rng, 100) < r->crit_pct) {
+        damage = damage * r->crit_mult;
+    }
+    if (r->low_hp_bonus && st->hp < st->max_hp * r->low_hp_frac) {
+        damage += r->low_hp_bonus;
+    }
+    damage += st->level * r->level_mul;
+
+    // 随机波动
+    int variation = damage * r->variance;
+    damage += rng_range(rng, 2 * variation + 1) - variation;
+
+    // 确保最小伤害为1
+    if (damage < 1) damage = 1;
+
+    if (mp_cost) {
+        int cost = r->mp_cost_div > 0 ? damage / r->mp_cost_div + r->mp_cost_base : 0;
+        if (cost > st->mp) cost = st->mp; // 最多消耗所有魔法值
+        *mp_cost = cost;
+    }
+    return damage;
+}
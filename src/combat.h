@@ -0,0 +1,69 @@
+/* combat.h - data-driven combat rules
+ *
+ * Damage parameters are read from a text file (res/rules/combat by default,
+ * see config_get_rules_path) and compiled into one flat CombatRule per job
+ * and attack mode, so evaluation is a table lookup plus straight-line math.
+ * Built-in defaults matching the shipped file apply when it is missing.
+ */
+#ifndef COMBAT_H
+#define COMBAT_H
+
+#include "job.h"
+#include "rng.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    double attack_mul;      /* damage per point of attack */
+    double defense_mul;     /* damage removed per point of defense */
+    double mp_mul;          /* damage per point of attacker MP */
+    double job_bonus;       /* extra damage, fraction of attack */
+    int flat;               /* flat bonus */
+    int crit_pct;           /* crit chance in percent */
+    double crit_mult;       /* damage multiplier on crit */
+    int low_hp_bonus;       /* bonus against a target below low_hp_frac of max HP */
+    double low_hp_frac;
+    int level_mul;          /* damage per attacker level */
+    double variance;        /* +/- fraction of damage rolled uniformly */
+    int mp_cost_div;        /* MP cost = damage / div + base; 0 = free */
+    int mp_cost_base;
+} CombatRule;
+
+/* the stats one exchange reads */
+typedef struct {
+    int attack, level, mp;          /* attacker */
+    int defense, hp, max_hp;        /* defender */
+} CombatStats;
+
+/* Parameters of the skill-based formulas in action.c:
+ * attack * attack_mul + power - defense * defense_mul, times crit_mult on crit */
+typedef struct {
+    double attack_mul;
+    double defense_mul;
+    double crit_mult;
+} ActionRule;
+
+/* Load rules from `path`, replacing the current table. Lines are
+ * "<mode>.<key> = <value>" (all jobs) or "<job>.<mode>.<key> = <value>"
+ * (one job, applied after the mode-wide lines), plus "action.<key> = <value>".
+ * Returns the number of settings applied, or -1 if the file can't be read
+ * (the table is then left at the built-in defaults). */
+int combat_rules_load(const char *path);
+/* reset to built-in defaults */
+void combat_rules_defaults(void);
+
+/* rule for a job and AttackMode; ATTACK_MODE_NONE resolves like physical */
+const CombatRule *combat_rule(JobType job, int attack_mode);
+const ActionRule *combat_action_rule(void);
+
+/* Damage of one exchange (at least 1). Rolls crit then variance from `rng`.
+ * `*mp_cost` (optional) receives the MP the attacker spends, capped at its MP. */
+int combat_eval(const CombatRule *r, const CombatStats *st, Rng *rng, int *mp_cost);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMBAT_H */
@@ -0,0 +1,121 @@
+/* combatbatch.c - resolve many attacks at once over the unit store */
+#include <stdlib.h>
+#include <string.h>
+
+#include "combat.h"
+#include "combatbatch.h"
+
+#define FIELD_LIST(X) \
+    X(attacker) X(defender) X(mode) X(damage) \
+    X(atk) X(level) X(mp) X(def) X(hp) X(max_hp) \
+    X(job_bonus) X(crit_mult) X(low_hp_frac) X(variance) \
+    X(flat) X(crit_pct) X(low_hp_bonus) X(level_mul) X(mp_cost_div) X(mp_cost_base) \
+    X(roll_crit) X(roll_var) X(raw) X(cost)
+
+static int batch_grow(CombatBatch *b) {
+    int cap = b->cap ? b->cap * 2 : 256;
+#define GROW(f) { void *p = realloc(b->f, sizeof(*b->f) * cap); if (!p) return -1; b->f = p; }
+    FIELD_LIST(GROW)
+#undef GROW
+    b->cap = cap;
+    return 0;
+}
+
+void combat_batch_reset(CombatBatch *b) {
+    b->count = 0;
+}
+
+int combat_batch_add(CombatBatch *b, UnitId attacker, UnitId defender, int mode) {
+    if (b->count == b->cap && batch_grow(b) != 0) return -1;
+    int i = b->count++;
+    b->attacker[i] = attacker;
+    b->defender[i] = defender;
+    b->mode[i] = mode;
+    b->damage[i] = 0;
+    return i;
+}
+
+/* copy unit stats and rule parameters into the batch's arrays; stale
+ * exchanges get a zero multiplier and are skipped when applying */
+static void gather(CombatBatch *b) {
+    for (int i = 0; i < b->count; ++i) {
+        int a = unit_index(b->attacker[i]), d = unit_index(b->defender[i]);
+        if (a < 0 || d < 0) {
+            b->attacker[i] = UNIT_NONE;
+            a = d = -1;
+        }
+        const CombatRule *r = combat_rule(a >= 0 ? (JobType)g_units.job[a] : JOB_WARRIOR, b->mode[i]);
+        b->atk[i] = a >= 0 ? g_units.attack[a] : 0;
+        b->level[i] = a >= 0 ? g_units.level[a] : 0;
+        b->mp[i] = a >= 0 ? g_units.mp[a] : 0;
+        b->def[i] = d >= 0 ? g_units.defense[d] : 0;
+        b->hp[i] = d >= 0 ? g_units.hp[d] : 0;
+        b->max_hp[i] = d >= 0 ? g_units.max_hp[d] : 0;
+        b->job_bonus[i] = r->job_bonus;
+        b->crit_mult[i] = r->crit_mult;
+        b->low_hp_frac[i] = r->low_hp_frac;
+        b->variance[i] = r->variance;
+        b->flat[i] = r->flat;
+        b->crit_pct[i] = r->crit_pct;
+        b->low_hp_bonus[i] = r->low_hp_bonus;
+        b->level_mul[i] = r->level_mul;
+        b->mp_cost_div[i] = r->mp_cost_div;
+        b->mp_cost_base[i] = r->mp_cost_base;
+        /* attack, MP and defense terms, truncated exactly as in combat_eval */
+        b->raw[i] = b->atk[i] * r->attack_mul + b->mp[i] * r->mp_mul - b->def[i] * r->defense_mul;
+    }
+}
+
+long combat_batch_resolve(CombatBatch *b, Rng *rng) {
+    int n = b->count;
+    if (n == 0) return 0;
+    gather(b);
+    for (int i = 0; i < n; ++i) {
+        b->roll_crit[i] = rng_next(rng);
+        b->roll_var[i] = rng_next(rng);
+    }
+
+    /* straight-line arithmetic over the arrays; selects instead of branches */
+    for (int i = 0; i < n; ++i) {
+        int damage = b->raw[i];
+        damage += b->atk[i] * b->job_bonus[i];
+        damage += b->flat[i];
+        int crit_roll = (int)(((uint64_t)b->roll_crit[i] * 100u) >> 32);
+        int crit_damage = damage * b->crit_mult[i];
+        damage = crit_roll < b->crit_pct[i] ? crit_damage : damage;
+        int low = b->hp[i] < b->max_hp[i] * b->low_hp_frac[i];
+        damage += low ? b->low_hp_bonus[i] : 0;
+        damage += b->level[i] * b->level_mul[i];
+        int variation = damage * b->variance[i];
+        int span = 2 * variation + 1;
+        int roll = span > 0 ? (int)(((uint64_t)b->roll_var[i] * (uint32_t)span) >> 32) : 0;
+        damage += roll - variation;
+        damage = damage < 1 ? 1 : damage;
+        int div = b->mp_cost_div[i] > 0 ? b->mp_cost_div[i] : 1;
+        int cost = b->mp_cost_div[i] > 0 ? damage / div + b->mp_cost_base[i] : 0;
+        b->cost[i] = cost > b->mp[i] ? b->mp[i] : cost;
+        b->raw[i] = damage;
+    }
+
+    /* apply in queue order so the result is independent of evaluation order */
+    long total = 0;
+    for (int i = 0; i < n; ++i) {
+        if (b->attacker[i] == UNIT_NONE) { b->damage[i] = 0; continue; }
+        int a = unit_index(b->attacker[i]), d = unit_index(b->defender[i]);
+        int dmg = b->raw[i] < g_units.hp[d] ? b->raw[i] : g_units.hp[d];
+        g_units.hp[d] -= dmg;
+        int cost = b->cost[i] < g_units.mp[a] ? b->cost[i] : g_units.mp[a];
+        g_units.mp[a] -= cost;
+        b->damage[i] = dmg;
+        total += dmg;
+    }
+    b->count = 0;
+    return total;
+}
+
+void combat_batch_free(CombatBatch *b) {
+#define RELEASE(f) free(b->f);
+    FIELD_LIST(RELEASE)
+#undef RELEASE
+    memset(b, 0, sizeof(*b));
+}
@@ -0,0 +1,50 @@
+/* combatbatch.h - resolve many attacks at once over the unit store */
+#ifndef COMBATBATCH_H
+#define COMBATBATCH_H
+
+#include "rng.h"
+#include "units.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Queued exchanges plus the structure-of-arrays scratch the resolver works
+ * in. Buffers are kept between batches, so a zero-initialized CombatBatch
+ * can be reused indefinitely.
+ */
+typedef struct {
+    UnitId *attacker, *defender;
+    int *mode;              /* AttackMode per exchange */
+    int *damage;            /* out: HP actually removed per exchange */
+    int count, cap;
+    /* per-exchange inputs gathered from the unit store and rules table */
+    int *atk, *level, *mp, *def, *hp, *max_hp;
+    double *job_bonus, *crit_mult, *low_hp_frac, *variance;
+    int *flat, *crit_pct, *low_hp_bonus, *level_mul, *mp_cost_div, *mp_cost_base;
+    uint32_t *roll_crit, *roll_var;
+    int *raw, *cost;        /* computed damage and MP cost before applying */
+} CombatBatch;
+
+void combat_batch_reset(CombatBatch *b);
+
+/* queue one attack; returns its index in the batch, or -1 if out of memory */
+int combat_batch_add(CombatBatch *b, UnitId attacker, UnitId defender, int mode);
+
+/* Resolve every queued exchange as simultaneous, with the formulas of
+ * combat_eval: all damage is computed from the stats at the start of the
+ * batch, then HP and MP changes are applied in queue order (HP floors at 0,
+ * MP cost is capped by the MP left). Each exchange draws exactly two numbers
+ * from `rng`, so the outcome depends only on the inputs and the stream.
+ * Exchanges naming a stale unit deal 0. Empties the queue; results stay in
+ * b->damage until the next add. Returns the total damage dealt.
+ */
+long combat_batch_resolve(CombatBatch *b, Rng *rng);
+
+void combat_batch_free(CombatBatch *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMBATBATCH_H */
@@ -1,6 +1,8 @@
 /* config.c - runtime configuration for 2048civ
  * Supports simple environment-variable overrides.
  */
+#include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,6 +18,8 @@
 #define DEFAULT_SPLIT_RATIO 0.8f /* main area fraction (e.g. 0.8 == 4/5) */
 /* movement defaults (milliseconds per tile) */
 #define DEFAULT_MOVE_MS 200
+/* combat rules data file, relative to the working directory */
+#define DEFAULT_RULES_PATH "res/rules/combat"
 
 static int s_map_rows = DEFAULT_MAP_ROWS;
 static int s_map_cols = DEFAULT_MAP_COLS;
@@ -25,6 +29,11 @@ static int s_window_width = DEFAULT_WINDOW_WIDTH;
 static int s_window_height = DEFAULT_WINDOW_HEIGHT;
 static float s_split_ratio = DEFAULT_SPLIT_RATIO;
 static int s_move_ms = DEFAULT_MOVE_MS;
+static unsigned int s_seed = 0;
+static int s_vsync = 1;
+static int s_fog = 1;
+static char s_profile_csv[512] = {0};
+static char s_rules_path[512] = {0};
 /* perlin defaults */
 static PerlinParams s_perlin_params = {
     .scale = 0.03f,
@@ -36,6 +45,16 @@ static PerlinParams s_perlin_params = {
 };
 static int s_initialized = 0;
 
+/* unsigned decimal seed; the whole string must parse and fit in 32 bits */
+static int parse_seed(const char* s, unsigned int* out) {
+    char* end;
+    errno = 0;
+    unsigned long v = strtoul(s, &end, 10);
+    if (end == s || *end != '\0' || errno == ERANGE || v > UINT_MAX) return 0;
+    *out = (unsigned int)v;
+    return 1;
+}
+
 static void apply_env_overrides(void) {
     const char* e;
     e = getenv("2048CIV_MAP_ROWS");
@@ -78,6 +97,25 @@ static void apply_env_overrides(void) {
         int v = atoi(e);
         if (v > 0) s_move_ms = v;
     }
+    e = getenv("2048CIV_VSYNC");
+    if (e && e[0]) s_vsync = atoi(e) != 0;
+    e = getenv("2048CIV_FOG");
+    if (e && e[0]) s_fog = atoi(e) != 0;
+    e = getenv("2048CIV_PROFILE_CSV");
+    if (e && e[0]) {
+        strncpy(s_profile_csv, e, sizeof(s_profile_csv)-1);
+        s_profile_csv[sizeof(s_profile_csv)-1] = '\0';
+    }
+    e = getenv("2048CIV_RULES");
+    if (e && e[0]) {
+        strncpy(s_rules_path, e, sizeof(s_rules_path)-1);
+        s_rules_path[sizeof(s_rules_path)-1] = '\0';
+    }
+    e = getenv("2048CIV_SEED");
+    if (e) {
+        unsigned int v;
+        if (parse_seed(e, &v) && v != 0) s_seed = v;
+    }
     /* perlin overrides */
     e = getenv("2048CIV_PERLIN_SCALE");
     if (e) {
@@ -106,8 +144,8 @@ static void apply_env_overrides(void) {
     }
     e = getenv("2048CIV_PERLIN_SEED");
     if (e) {
-        unsigned int v = (unsigned int)atoi(e);
-        if (v != 0) s_perlin_params.seed = v;
+        unsigned int v;
+        if (parse_seed(e, &v) && v != 0) s_perlin_params.seed = v;
     }
 }
 
@@ -120,6 +158,12 @@ int config_init(void) {
     s_window_height = DEFAULT_WINDOW_HEIGHT;
     s_split_ratio = DEFAULT_SPLIT_RATIO;
     s_move_ms = DEFAULT_MOVE_MS;
+    s_seed = 0;
+    s_vsync = 1;
+    s_fog = 1;
+    s_profile_csv[0] = '\0';
+    strncpy(s_rules_path, DEFAULT_RULES_PATH, sizeof(s_rules_path)-1);
+    s_rules_path[sizeof(s_rules_path)-1] = '\0';
     /* reset perlin defaults */
     s_perlin_params.scale = 0.03f;
     s_perlin_params.octaves = 5;
@@ -179,6 +223,31 @@ int config_get_move_ms(void) {
     return s_move_ms;
 }
 
+int config_get_vsync(void) {
+    if (!s_initialized) config_init();
+    return s_vsync;
+}
+
+int config_get_fog(void) {
+    if (!s_initialized) config_init();
+    return s_fog;
+}
+
+const char* config_get_profile_csv(void) {
+    if (!s_initialized) config_init();
+    return s_profile_csv;
+}
+
+const char* config_get_rules_path(void) {
+    if (!s_initialized) config_init();
+    return s_rules_path;
+}
+
+unsigned int config_get_seed(void) {
+    if (!s_initialized) config_init();
+    return s_seed;
+}
+
 void config_free(void) {
     /* nothing to free now, placeholder for future resources */
     s_initialized = 0;
@@ -16,6 +16,16 @@ int config_get_window_height(void);
 float config_get_split_ratio(void);
 /* movement speed (ms per tile) */
 int config_get_move_ms(void);
+/* non-zero to request vsync-paced presentation */
+int config_get_vsync(void);
+/* non-zero to hide cells the player's units have not seen */
+int config_get_fog(void);
+/* path of the frame profile CSV written on exit ("" = disabled) */
+const char* config_get_profile_csv(void);
+/* combat rules data file (see combat.h) */
+const char* config_get_rules_path(void);
+/* master random seed (0 = time-based) */
+unsigned int config_get_seed(void);
 /* perlin params */
 #include "perlin.h"
 void config_get_perlin_params(PerlinParams* out);
@@ -0,0 +1,71 @@
+/* dirty.c - damaged screen regions for partial redraws
+ *
+ * Keeps a short list of disjoint rectangles; a new rectangle absorbs every
+ * one it overlaps, so redrawing the list never touches a pixel twice.
+ */
+#include "dirty.h"
+
+static DirtyRect s_rects[DIRTY_MAX_RECTS];
+static int s_count = 0;
+static int s_width = 0, s_height = 0;
+
+static int overlaps(const DirtyRect* a, const DirtyRect* b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w &&
+           a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static void unite(DirtyRect* a, const DirtyRect* b) {
+    int x0 = a->x < b->x ? a->x : b->x;
+    int y0 = a->y < b->y ? a->y : b->y;
+    int x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+    a->x = x0; a->y = y0; a->w = x1 - x0; a->h = y1 - y0;
+}
+
+void dirty_set_bounds(int width, int height) {
+    s_width = width;
+    s_height = height;
+    dirty_mark_all();
+}
+
+void dirty_add(int x, int y, int w, int h) {
+    /* clip to bounds */
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > s_width) w = s_width - x;
+    if (y + h > s_height) h = s_height - y;
+    if (w <= 0 || h <= 0) return;
+
+    DirtyRect r = { x, y, w, h };
+    /* absorb overlapping rects until r is disjoint from the rest */
+    int merged = 1;
+    while (merged) {
+        merged = 0;
+        for (int i = 0; i < s_count; ++i) {
+            if (!overlaps(&r, &s_rects[i])) continue;
+            unite(&r, &s_rects[i]);
+            s_rects[i] = s_rects[--s_count];
+            merged = 1;
+            break;
+        }
+    }
+    if (s_count == DIRTY_MAX_RECTS) {
+        for (int i = 0; i < s_count; ++i) unite(&r, &s_rects[i]);
+        s_count = 0;
+    }
+    s_rects[s_count++] = r;
+}
+
+void dirty_mark_all(void) {
+    s_count = 0;
+    if (s_width > 0 && s_height > 0) {
+        DirtyRect r = { 0, 0, s_width, s_height };
+        s_rects[s_count++] = r;
+    }
+}
+
+int dirty_count(void) { return s_count; }
+
+const DirtyRect* dirty_rects(void) { return s_rects; }
+
+void dirty_clear(void) { s_count = 0; }
@@ -0,0 +1,35 @@
+/* dirty.h - damaged screen regions for partial redraws */
+#ifndef DIRTY_H
+#define DIRTY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* beyond this many disjoint regions everything is merged into one */
+#define DIRTY_MAX_RECTS 32
+
+typedef struct {
+    int x, y, w, h;
+} DirtyRect;
+
+/* set the surface size that regions are clipped to; marks everything dirty */
+void dirty_set_bounds(int width, int height);
+
+/* add a damaged region; overlapping regions are merged */
+void dirty_add(int x, int y, int w, int h);
+
+/* damage the whole surface */
+void dirty_mark_all(void);
+
+int dirty_count(void);
+const DirtyRect* dirty_rects(void);
+
+/* forget all regions once they have been redrawn */
+void dirty_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIRTY_H */
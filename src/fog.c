@@ -0,0 +1,196 @@
+/* fog.c - fog of war: per-faction explored/visible cell bitsets */
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fog.h"
+#include "units.h"
+
+typedef struct {
+    uint64_t *visible;
+    uint64_t *explored;
+    uint64_t *diff;         /* old ^ new visible bits of the last fog_update */
+    int row_lo, row_hi;     /* rows holding visible bits; empty when lo > hi */
+    int diff_lo, diff_hi;   /* rows of diff that may be non-zero */
+    FogSpan changed;
+} FogLayer;
+
+static struct {
+    int rows, cols, words;  /* words per row */
+    FogLayer layer[FOG_MAX_FACTIONS];
+} s_fog;
+
+static int fog_on(void) {
+    return s_fog.rows > 0;
+}
+
+static void span_clear(FogSpan *s) {
+    s->row_lo = s->col_lo = 0;
+    s->row_hi = s->col_hi = -1;
+}
+
+int fog_init(int rows, int cols) {
+    fog_free();
+    if (rows <= 0 || cols <= 0) return -1;
+    s_fog.rows = rows;
+    s_fog.cols = cols;
+    s_fog.words = (cols + 63) / 64;
+    for (int f = 0; f < FOG_MAX_FACTIONS; ++f) {
+        FogLayer *l = &s_fog.layer[f];
+        l->row_lo = l->diff_lo = 0;
+        l->row_hi = l->diff_hi = -1;
+        span_clear(&l->changed);
+    }
+    return 0;
+}
+
+void fog_free(void) {
+    for (int f = 0; f < FOG_MAX_FACTIONS; ++f) {
+        free(s_fog.layer[f].visible);
+        free(s_fog.layer[f].explored);
+        free(s_fog.layer[f].diff);
+    }
+    memset(&s_fog, 0, sizeof(s_fog));
+}
+
+int fog_enabled(void) {
+    return fog_on();
+}
+
+static FogLayer *layer_for(int faction) {
+    if (!fog_on() || faction < 0 || faction >= FOG_MAX_FACTIONS) return NULL;
+    FogLayer *l = &s_fog.layer[faction];
+    if (!l->visible) {
+        size_t n = (size_t)s_fog.rows * s_fog.words;
+        l->visible = calloc(n, sizeof(uint64_t));
+        l->explored = calloc(n, sizeof(uint64_t));
+        l->diff = calloc(n, sizeof(uint64_t));
+        if (!l->visible || !l->explored || !l->diff) {
+            free(l->visible); free(l->explored); free(l->diff);
+            l->visible = l->explored = l->diff = NULL;
+            return NULL;
+        }
+    }
+    return l;
+}
+
+int fog_reveal(int faction, const FovMask *m) {
+    FogLayer *l = layer_for(faction);
+    if (!l || !m) return 0;
+    uint64_t grown = 0;
+    int c0 = m->col - m->radius;
+    for (int i = 0; i <= 2 * m->radius; ++i) {
+        uint64_t bits = m->mask[i];
+        if (!bits) continue;
+        int row = m->row - m->radius + i;
+        int col = c0;
+        /* mask bits are on-map cells only, so dropping the left overhang
+         * loses nothing */
+        if (col < 0) { bits >>= -col; col = 0; }
+        int w = col >> 6, off = col & 63;
+        uint64_t *vis = l->visible + (size_t)row * s_fog.words;
+        uint64_t *exp = l->explored + (size_t)row * s_fog.words;
+        uint64_t lo = bits << off;
+        vis[w] |= lo;
+        grown |= lo & ~exp[w];
+        exp[w] |= lo;
+        if (off && w + 1 < s_fog.words) {
+            uint64_t hi = bits >> (64 - off);
+            vis[w + 1] |= hi;
+            grown |= hi & ~exp[w + 1];
+            exp[w + 1] |= hi;
+        }
+        if (row < l->row_lo || l->row_lo > l->row_hi) l->row_lo = row;
+        if (row > l->row_hi) l->row_hi = row;
+    }
+    return grown ? FOG_EXPLORED_CHANGED : 0;
+}
+
+int fog_update(int faction) {
+    FogLayer *l = layer_for(faction);
+    if (!l) return 0;
+    size_t words = (size_t)s_fog.words;
+    /* diff starts as the old visible rows and is zero everywhere else */
+    if (l->diff_lo <= l->diff_hi)
+        memset(l->diff + l->diff_lo * words, 0, (size_t)(l->diff_hi - l->diff_lo + 1) * words * sizeof(uint64_t));
+    int old_lo = l->row_lo, old_hi = l->row_hi;
+    if (old_lo <= old_hi) {
+        size_t off = old_lo * words, n = (size_t)(old_hi - old_lo + 1) * words;
+        memcpy(l->diff + off, l->visible + off, n * sizeof(uint64_t));
+        memset(l->visible + off, 0, n * sizeof(uint64_t));
+    }
+    l->row_lo = 0; l->row_hi = -1;
+
+    int flags = 0;
+    for (int k = 0; k < g_units.count; ++k) {
+        if (g_units.faction[k] != faction || g_units.hp[k] <= 0) continue;
+        flags |= fog_reveal(faction, fov_unit(g_units.id[k]));
+    }
+
+    /* XOR in the new rows over both spans; the bits left set changed */
+    int lo = old_lo, hi = old_hi;
+    if (lo > hi) {
+        lo = l->row_lo; hi = l->row_hi;
+    } else if (l->row_lo <= l->row_hi) {
+        if (l->row_lo < lo) lo = l->row_lo;
+        if (l->row_hi > hi) hi = l->row_hi;
+    }
+    l->diff_lo = lo; l->diff_hi = hi;
+    FogSpan *ch = &l->changed;
+    ch->row_lo = ch->col_lo = INT_MAX;
+    ch->row_hi = ch->col_hi = -1;
+    for (int row = lo; row <= hi; ++row) {
+        uint64_t *d = l->diff + row * words;
+        const uint64_t *v = l->visible + row * words;
+        int any = 0;
+        for (size_t w = 0; w < words; ++w) {
+            d[w] ^= v[w];
+            if (!d[w]) continue;
+            int first = (int)(w * 64) + __builtin_ctzll(d[w]);
+            int last = (int)(w * 64) + 63 - __builtin_clzll(d[w]);
+            if (first < ch->col_lo) ch->col_lo = first;
+            if (last > ch->col_hi) ch->col_hi = last;
+            any = 1;
+        }
+        if (!any) continue;
+        if (row < ch->row_lo) ch->row_lo = row;
+        ch->row_hi = row;
+    }
+    if (ch->row_hi < 0) span_clear(ch);
+    else flags |= FOG_VISIBLE_CHANGED;
+    return flags;
+}
+
+void fog_changed_span(int faction, FogSpan *out) {
+    FogLayer *l = fog_on() && faction >= 0 && faction < FOG_MAX_FACTIONS ? &s_fog.layer[faction] : NULL;
+    if (l) *out = l->changed;
+    else span_clear(out);
+}
+
+static int bit_at(const uint64_t *bits, int row, int col) {
+    return (int)((bits[(size_t)row * s_fog.words + (col >> 6)] >> (col & 63)) & 1);
+}
+
+int fog_visible(int faction, int row, int col) {
+    if (!fog_on()) return 1;
+    if (row < 0 || row >= s_fog.rows || col < 0 || col >= s_fog.cols) return 0;
+    FogLayer *l = layer_for(faction);
+    return l ? bit_at(l->visible, row, col) : 1;
+}
+
+int fog_explored(int faction, int row, int col) {
+    if (!fog_on()) return 1;
+    if (row < 0 || row >= s_fog.rows || col < 0 || col >= s_fog.cols) return 0;
+    FogLayer *l = layer_for(faction);
+    return l ? bit_at(l->explored, row, col) : 1;
+}
+
+long fog_explored_count(int faction) {
+    if (!fog_on()) return 0;
+    FogLayer *l = layer_for(faction);
+    if (!l) return 0;
+    long n = 0;
+    size_t words = (size_t)s_fog.rows * s_fog.words;
+    for (size_t i = 0; i < words; ++i) n += __builtin_popcountll(l->explored[i]);
+    return n;
+}
@@ -0,0 +1,58 @@
+/* fog.h - fog of war: per-faction explored/visible cell bitsets */
+#ifndef FOG_H
+#define FOG_H
+
+#include <stdint.h>
+
+#include "fov.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FOG_MAX_FACTIONS 8
+
+/* change flags returned by fog_update */
+#define FOG_VISIBLE_CHANGED  1
+#define FOG_EXPLORED_CHANGED 2
+
+/* Bounding box of the cells whose visibility changed in the last fog_update;
+ * empty when row_lo > row_hi. Newly explored cells are always inside it,
+ * since a cell is explored the first time it becomes visible. */
+typedef struct {
+    int row_lo, row_hi;
+    int col_lo, col_hi;
+} FogSpan;
+
+/* Each map row is stored as ceil(cols / 64) words, one bit per cell, so a
+ * unit's view (one word per row, see FovMask) is ORed in a word or two per
+ * row. A faction's bitsets are allocated on first use.
+ */
+
+/* Enable fog for a rows x cols map. Until then (and after fog_free) every
+ * cell counts as visible and explored, so callers need not check. Returns 0
+ * on success, -1 if out of memory. */
+int fog_init(int rows, int cols);
+void fog_free(void);
+int fog_enabled(void);
+
+/* OR a view into `faction`'s visible and explored sets; returns
+ * FOG_EXPLORED_CHANGED if it uncovered new cells, else 0 */
+int fog_reveal(int faction, const FovMask *m);
+/* Rebuild `faction`'s visible set from the cached views of its living
+ * units (fov_unit). Only rows touched last time are cleared. Returns
+ * FOG_* flags for what changed. */
+int fog_update(int faction);
+/* what the last fog_update of `faction` changed */
+void fog_changed_span(int faction, FogSpan *out);
+
+int fog_visible(int faction, int row, int col);
+int fog_explored(int faction, int row, int col);
+/* explored cells of `faction` (0 while fog is off) */
+long fog_explored_count(int faction);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOG_H */
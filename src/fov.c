@@ -0,0 +1,169 @@
+/* fov.c - line of sight and shadowcast field of view on the hex map */
+#include <stdlib.h>
+#include <string.h>
+
+#include "fov.h"
+#include "hex_utils.h"
+#include "job.h"
+#include "world.h"
+
+/* Angles are fractions of a full turn measured along the ring walk: cell i
+ * of ring k is centered at i / 6k and spans half a cell either side. All
+ * bounds are single divisions of small integers, so equal fractions compare
+ * equal exactly. */
+typedef struct { double lo, hi; } Arc;
+
+#define FOV_MAX_ARCS (8 * FOV_MAX_RADIUS + 8)
+
+/* axial (q,r) steps in ring-walk order, as in hex_utils.c */
+static const int FOV_DIR_Q[6] = { 1, 1, 0, -1, -1, 0 };
+static const int FOV_DIR_R[6] = { 0, -1, -1, 0, 1, 1 };
+
+typedef struct {
+    FovMask *mask;
+    UnitId *id;
+    int cap;
+    long recomputes;
+} FovCache;
+
+static FovCache s_cache;
+
+int terrain_blocks_sight(Terrain t) {
+    return t == TERRAIN_MOUNTAIN || t == TERRAIN_FOREST;
+}
+
+static int cell_blocks(int row, int col) {
+    if (row < 0 || row >= g_map_rows || col < 0 || col >= g_map_cols) return 1;
+    return terrain_blocks_sight(TERRAIN_AT(row, col));
+}
+
+int fov_line_clear(int r1, int c1, int r2, int c2) {
+    int buf_r[64], buf_c[64];
+    int *lr = buf_r, *lc = buf_c;
+    int n = hex_distance_cells(r1, c1, r2, c2) + 1;
+    if (n > 64) {
+        lr = malloc(sizeof(int) * 2 * n);
+        if (!lr) return 0;
+        lc = lr + n;
+    }
+    hex_line(r1, c1, r2, c2, lr, lc, n);
+    int clear = 1;
+    for (int i = 1; i < n - 1 && clear; ++i) clear = !cell_blocks(lr[i], lc[i]);
+    if (lr != buf_r) free(lr);
+    return clear;
+}
+
+/* 1 if angle a lies strictly inside a shadow */
+static int arc_covered(const Arc *arcs, int n, double a) {
+    for (int i = 0; i < n && arcs[i].lo < a; ++i) {
+        if (a < arcs[i].hi) return 1;
+    }
+    return 0;
+}
+
+/* add [lo,hi] keeping the list sorted and merging arcs that touch */
+static int arc_add(Arc *arcs, int n, double lo, double hi) {
+    int i = 0;
+    while (i < n && arcs[i].hi < lo) ++i;
+    int j = i;
+    while (j < n && arcs[j].lo <= hi) {
+        if (arcs[j].lo < lo) lo = arcs[j].lo;
+        if (arcs[j].hi > hi) hi = arcs[j].hi;
+        ++j;
+    }
+    if (j == i) {
+        if (n >= FOV_MAX_ARCS) return n;
+        memmove(arcs + i + 1, arcs + i, sizeof(Arc) * (n - i));
+        ++n;
+    } else if (j > i + 1) {
+        memmove(arcs + i + 1, arcs + j, sizeof(Arc) * (n - j));
+        n -= j - i - 1;
+    }
+    arcs[i].lo = lo; arcs[i].hi = hi;
+    return n;
+}
+
+static void mask_set(FovMask *m, int row, int col) {
+    if (row < 0 || row >= g_map_rows || col < 0 || col >= g_map_cols) return;
+    m->mask[row - m->row + m->radius] |= 1ull << (col - m->col + m->radius);
+}
+
+void fov_compute(int row, int col, int radius, FovMask *out) {
+    if (radius < 0) radius = 0;
+    if (radius > FOV_MAX_RADIUS) radius = FOV_MAX_RADIUS;
+    out->row = row; out->col = col; out->radius = radius;
+    memset(out->mask, 0, sizeof(out->mask));
+    mask_set(out, row, col);
+
+    Arc arcs[FOV_MAX_ARCS];
+    int narcs = 0;
+    int r0 = row - (col - (col & 1)) / 2;
+    for (int k = 1; k <= radius; ++k) {
+        /* once one arc spans the whole turn nothing further is visible */
+        if (narcs > 0 && arcs[0].lo <= 0.0 && arcs[0].hi >= 1.0) break;
+        int q = col + FOV_DIR_Q[4] * k, r = r0 + FOV_DIR_R[4] * k;
+        int i = 0;
+        for (int side = 0; side < 6; ++side) {
+            for (int step = 0; step < k; ++step, ++i) {
+                int crow = r + (q - (q & 1)) / 2;
+                if (!arc_covered(arcs, narcs, (double)(2 * i) / (12 * k))) mask_set(out, crow, q);
+                if (cell_blocks(crow, q)) {
+                    narcs = arc_add(arcs, narcs, (double)(2 * i - 1) / (12 * k), (double)(2 * i + 1) / (12 * k));
+                    /* cell 0 straddles angle 0: also shadow its wrapped copy */
+                    if (i == 0) narcs = arc_add(arcs, narcs, (double)(12 * k - 1) / (12 * k), (double)(12 * k + 1) / (12 * k));
+                }
+                q += FOV_DIR_Q[side];
+                r += FOV_DIR_R[side];
+            }
+        }
+    }
+}
+
+int fov_visible(const FovMask *m, int row, int col) {
+    int i = row - m->row + m->radius, j = col - m->col + m->radius;
+    if (i < 0 || i > 2 * m->radius || j < 0 || j > 2 * m->radius) return 0;
+    return (int)((m->mask[i] >> j) & 1);
+}
+
+static int cache_reserve(int slot) {
+    if (slot < s_cache.cap) return 1;
+    int cap = s_cache.cap ? s_cache.cap : 64;
+    while (cap <= slot) cap *= 2;
+    FovMask *mask = realloc(s_cache.mask, sizeof(FovMask) * cap);
+    if (!mask) return 0;
+    s_cache.mask = mask;
+    UnitId *id = realloc(s_cache.id, sizeof(UnitId) * cap);
+    if (!id) return 0;
+    s_cache.id = id;
+    memset(s_cache.id + s_cache.cap, 0, sizeof(UnitId) * (cap - s_cache.cap));
+    s_cache.cap = cap;
+    return 1;
+}
+
+const FovMask *fov_unit(UnitId id) {
+    int k = unit_index(id);
+    if (k < 0) return NULL;
+    int slot = (int)(id & ((1u << UNIT_SLOT_BITS) - 1));
+    if (!cache_reserve(slot)) return NULL;
+    FovMask *m = &s_cache.mask[slot];
+    int sight = job_sight((JobType)g_units.job[k]);
+    if (sight > FOV_MAX_RADIUS) sight = FOV_MAX_RADIUS;
+    /* a reused slot carries a different generation, so the id check also
+     * catches masks left behind by destroyed units */
+    if (s_cache.id[slot] != id || m->row != g_units.x[k] || m->col != g_units.y[k] || m->radius != sight) {
+        fov_compute(g_units.x[k], g_units.y[k], sight, m);
+        s_cache.id[slot] = id;
+        s_cache.recomputes++;
+    }
+    return m;
+}
+
+long fov_recompute_count(void) {
+    return s_cache.recomputes;
+}
+
+void fov_clear(void) {
+    free(s_cache.mask);
+    free(s_cache.id);
+    memset(&s_cache, 0, sizeof(s_cache));
+}
@@ -0,0 +1,48 @@
+/* fov.h - line of sight and shadowcast field of view on the hex map */
+#ifndef FOV_H
+#define FOV_H
+
+#include <stdint.h>
+
+#include "path.h"
+#include "units.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* largest sight radius; a row of the mask (2R+1 cells) fits one word */
+#define FOV_MAX_RADIUS 31
+
+/* Cells visible from (row,col) within `radius`. Rows and columns of the map
+ * within the radius box map to bits: mask[i] bit j is cell
+ * (row - radius + i, col - radius + j). Only on-map cells are ever set. */
+typedef struct {
+    int row, col, radius;
+    uint64_t mask[2 * FOV_MAX_RADIUS + 1];
+} FovMask;
+
+/* mountains and forests block sight; the blocking cell itself is seen */
+int terrain_blocks_sight(Terrain t);
+
+/* 1 if no cell strictly between the two ends blocks sight */
+int fov_line_clear(int r1, int c1, int r2, int c2);
+
+/* Shadowcast from (row,col) ring by ring over g_terrain_map; radius is
+ * clamped to FOV_MAX_RADIUS. */
+void fov_compute(int row, int col, int radius, FovMask *out);
+int fov_visible(const FovMask *m, int row, int col);
+
+/* Field of view of a unit at its sight radius (from its job). Cached per
+ * unit and only recomputed after it moved or its sight changed; NULL for a
+ * stale handle. Call fov_clear after the terrain changes. */
+const FovMask *fov_unit(UnitId id);
+/* number of fov_unit calls that had to recompute */
+long fov_recompute_count(void);
+void fov_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOV_H */
@@ -0,0 +1,32 @@
+/* frameclock.c - fixed-timestep accumulator for game updates */
+#include "frameclock.h"
+
+void frame_clock_init(FrameClock* fc, double step_ms, int max_steps) {
+    if (!fc) return;
+    fc->step_ms = step_ms > 0.0 ? step_ms : 1.0;
+    fc->accumulator = 0.0;
+    fc->last_ms = -1.0;
+    fc->max_steps = max_steps > 0 ? max_steps : 1;
+}
+
+int frame_clock_advance(FrameClock* fc, double now_ms) {
+    if (!fc) return 0;
+    if (fc->last_ms < 0.0) fc->last_ms = now_ms;
+    double dt = now_ms - fc->last_ms;
+    fc->last_ms = now_ms;
+    if (dt > 0.0) fc->accumulator += dt;
+    int steps = (int)(fc->accumulator / fc->step_ms);
+    if (steps > fc->max_steps) {
+        steps = fc->max_steps;
+        fc->accumulator = 0.0;
+    } else {
+        fc->accumulator -= steps * fc->step_ms;
+    }
+    return steps;
+}
+
+void frame_clock_reset(FrameClock* fc, double now_ms) {
+    if (!fc) return;
+    fc->accumulator = 0.0;
+    fc->last_ms = now_ms;
+}
@@ -0,0 +1,31 @@
+/* frameclock.h - fixed-timestep accumulator for game updates */
+#ifndef FRAMECLOCK_H
+#define FRAMECLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    double step_ms;     /* length of one update step */
+    double accumulator; /* time not yet consumed by steps */
+    double last_ms;     /* timestamp of the previous advance, < 0 before the first */
+    int max_steps;      /* cap per advance so a long stall does not spiral */
+} FrameClock;
+
+void frame_clock_init(FrameClock* fc, double step_ms, int max_steps);
+
+/* Add the time elapsed since the previous call and return how many fixed
+ * steps to run now. Time beyond `max_steps` steps is dropped.
+ */
+int frame_clock_advance(FrameClock* fc, double now_ms);
+
+/* Restart timing at `now_ms` with an empty accumulator (e.g. when an
+ * animation starts after an idle period) */
+void frame_clock_reset(FrameClock* fc, double now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAMECLOCK_H */
@@ -0,0 +1,462 @@
+/* headless.c - run world generation, pathing and combat without a window
+ *
+ * Usage: 2048civ_headless [--units N] [--turns N] [--script FILE] [--batch] [--ct] [--fov] [--ai] [--estimate N] [--quiet]
+ * Map size, seed and Perlin params come from the usual 2048CIV_* variables.
+ * With --batch each turn's attacks are resolved together by the batch
+ * resolver (simultaneous exchanges) instead of one sprite_attack at a time.
+ * With --ct units act in charge-time order from the turn scheduler (one turn
+ * is TURN_BASE_MS of battle time) and magic users cast with a delay.
+ * With --fov every living unit's field of view is refreshed after each turn
+ * (recomputed only for units that moved) and ORed into its team's fog of war
+ * bitsets; the cost and explored cells are reported.
+ * With --ai team 1 is driven by the AI planner (ai.h): in the turn loop it is
+ * planned in AI_FRAME_BUDGET_MS slices after team 0 has acted, in --ct mode
+ * each unit is planned when its turn comes up.
+ * --estimate N first runs N Monte Carlo duels of unit 0 against unit 1.
+ *
+ * Script files hold one command per line ('#' starts a comment):
+ *   move <unit> <row> <col>    walk unit along the A* path (up to its move range)
+ *   attack <unit> <target>     resolve one sprite_attack
+ *   turns <n>                  run n random skirmish turns
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ai.h"
+#include "battlesim.h"
+#include "combat.h"
+#include "combatbatch.h"
+#include "config.h"
+#include "fog.h"
+#include "fov.h"
+#include "hex_utils.h"
+#include "intern.h"
+#include "job.h"
+#include "path.h"
+#include "region.h"
+#include "rng.h"
+#include "spatial.h"
+#include "sprite.h"
+#include "timing.h"
+#include "turnorder.h"
+#include "world.h"
+
+#define DEFAULT_UNITS 16
+#define DEFAULT_TURNS 50
+/* faction the AI plays with --ai */
+#define AI_FACTION 1
+
+typedef struct {
+    double worldgen_ms;
+    double path_ms;
+    int paths;
+    double attack_ms;
+    int attacks;
+    double turn_ms;
+    int turns;
+    double fov_ms;
+    long fov_refreshes;
+    double ai_ms;
+    int ai_plans;
+} SimStats;
+
+static Sprite **s_units = NULL;
+static int s_unit_count = 0;
+static int s_quiet = 0;
+static int s_batch = 0;
+static CombatBatch s_combat_batch;
+static int s_ct = 0;
+static TurnQueue s_turnq;
+static int s_fov = 0;
+static int s_ai = 0;
+static AiPlanner s_ai_planner;
+/* the spell magic users cast in --ct mode; only its cast time matters here */
+static const Skill s_bolt = { "Bolt", 0, 600, 0 };
+static SimStats s_stats;
+
+static const char *s_jobs[] = { "Warrior", "Mage", "Rogue", "Cleric", "Archer" };
+
+static int unit_alive(int i) {
+    return i >= 0 && i < s_unit_count && s_units[i] && SPRITE_FIELD(s_units[i], hp) > 0;
+}
+
+/* pick a random passable cell; falls back to any cell on a fully blocked map */
+static void random_land_cell(Rng *rng, int *r, int *c) {
+    for (int tries = 0; tries < 1000; ++tries) {
+        *r = rng_range(rng, g_map_rows);
+        *c = rng_range(rng, g_map_cols);
+        if (region_label_at(*r, *c) >= 0) return;
+    }
+}
+
+static Sprite *spawn_unit(int i, Rng *rng) {
+    char name[32];
+    snprintf(name, sizeof(name), "Unit%d", i);
+    Sprite *s = sprite_create(name, s_jobs[i % 5], NULL, 1);
+    if (!s) return NULL;
+    SPRITE_FIELD(s, level) = 1 + rng_range(rng, 10);
+    SPRITE_FIELD(s, max_hp) = 80 + rng_range(rng, 200 - 80 + 1);
+    SPRITE_FIELD(s, hp) = SPRITE_FIELD(s, max_hp);
+    SPRITE_FIELD(s, max_mp) = 10 + rng_range(rng, 80 - 10 + 1);
+    SPRITE_FIELD(s, mp) = SPRITE_FIELD(s, max_mp);
+    SPRITE_FIELD(s, attack) = 5 + rng_range(rng, 40 - 5 + 1);
+    SPRITE_FIELD(s, defense) = rng_range(rng, 31);
+    SPRITE_FIELD(s, speed) = 1 + rng_range(rng, 10);
+    SPRITE_FIELD(s, move) = 1 + rng_range(rng, 3);
+    SPRITE_FIELD(s, faction) = i % 2;
+    s->jump = 1 + rng_range(rng, 3);
+    int r = 0, c = 0;
+    random_land_cell(rng, &r, &c);
+    sprite_set_position(s, r, c);
+    return s;
+}
+
+/* walk `s` toward (tr,tc), stopping after its move range or before an occupied goal */
+static int move_sprite(Sprite *s, int tr, int tc, int stop_before_goal) {
+    double t0 = timing_now_ms();
+    compute_path(SPRITE_FIELD(s, x), SPRITE_FIELD(s, y), tr, tc);
+    s_stats.path_ms += timing_now_ms() - t0;
+    s_stats.paths++;
+    if (path_len < 2) return 0;
+    int last = path_len - 1 - (stop_before_goal ? 1 : 0);
+    if (last > SPRITE_FIELD(s, move)) last = SPRITE_FIELD(s, move);
+    if (last <= 0) return 0;
+    int idx = path_nodes[last];
+    sprite_set_position(s, idx / g_map_cols, idx % g_map_cols);
+    return last;
+}
+
+static int move_unit(int u, int tr, int tc, int stop_before_goal) {
+    return move_sprite(s_units[u], tr, tc, stop_before_goal);
+}
+
+static int attack_sprite(Sprite *atk, Sprite *def) {
+    double t0 = timing_now_ms();
+    int dmg = sprite_attack(atk, def, job_attack_mode((JobType)SPRITE_FIELD(atk, job)));
+    s_stats.attack_ms += timing_now_ms() - t0;
+    s_stats.attacks++;
+    if (!s_quiet) {
+        printf("  %s -> %s: %d damage (HP %d/%d)%s\n", atk->name, def->name, dmg,
+               SPRITE_FIELD(def, hp), SPRITE_FIELD(def, max_hp), SPRITE_FIELD(def, hp) <= 0 ? " defeated" : "");
+    }
+    return dmg;
+}
+
+static int attack_unit(int a, int d) {
+    if (!unit_alive(a) || !unit_alive(d)) return 0;
+    return attack_sprite(s_units[a], s_units[d]);
+}
+
+/* the scans below walk the unit store's arrays directly */
+static int team_alive(int team) {
+    for (int k = 0; k < g_units.count; ++k) {
+        if (g_units.faction[k] == team && g_units.hp[k] > 0) return 1;
+    }
+    return 0;
+}
+
+static int is_enemy_of(int dense, void *team) {
+    return g_units.faction[dense] != *(int *)team && g_units.hp[dense] > 0;
+}
+
+/* dense index of the closest living unit of another faction, or -1 */
+static int nearest_enemy(int k) {
+    int team = g_units.faction[k];
+    return spatial_nearest(g_units.x[k], g_units.y[k], -1, is_enemy_of, &team);
+}
+
+/* resolve the attacks queued during a --batch turn */
+static void flush_attacks(void) {
+    int n = s_combat_batch.count;
+    if (n == 0) return;
+    double t0 = timing_now_ms();
+    combat_batch_resolve(&s_combat_batch, rng_stream(RNG_STREAM_COMBAT));
+    s_stats.attack_ms += timing_now_ms() - t0;
+    s_stats.attacks += n;
+    for (int i = 0; !s_quiet && i < n; ++i) {
+        int a = unit_index(s_combat_batch.attacker[i]), d = unit_index(s_combat_batch.defender[i]);
+        if (a < 0 || d < 0) continue;
+        const Sprite *atk = g_units.owner[a], *def = g_units.owner[d];
+        printf("  %s -> %s: %d damage (HP %d/%d)%s\n", atk->name, def->name, s_combat_batch.damage[i],
+               g_units.hp[d], g_units.max_hp[d], g_units.hp[d] <= 0 ? " defeated" : "");
+    }
+}
+
+static int adjacent(const Sprite *a, const Sprite *b) {
+    return hex_distance_cells(SPRITE_FIELD(a, x), SPRITE_FIELD(a, y), SPRITE_FIELD(b, x), SPRITE_FIELD(b, y)) <= 1;
+}
+
+/* `s` attacks the adjacent `t`: queued with --batch, and in --ct mode magic
+ * users start a cast instead and hit when it resolves. Returns 1 if a cast
+ * was started. */
+static int strike(Sprite *s, Sprite *t) {
+    int mode = job_attack_mode((JobType)SPRITE_FIELD(s, job));
+    if (s_ct && mode == ATTACK_MODE_MAGIC) {
+        turnq_schedule_cast(&s_turnq, s, &s_bolt, 1.0f, (int)t->unit);
+        return 1;
+    }
+    if (s_batch) {
+        combat_batch_add(&s_combat_batch, s->unit, t->unit, mode);
+    } else {
+        attack_sprite(s, t);
+    }
+    return 0;
+}
+
+/* --ai: move to the planned cell and attack the planned target */
+static int follow_plan(const AiPlan *plan) {
+    int k = unit_index(plan->unit);
+    if (k < 0) return 0;
+    Sprite *s = g_units.owner[k];
+    s_stats.ai_plans++;
+    if (plan->row != g_units.x[k] || plan->col != g_units.y[k]) sprite_set_position(s, plan->row, plan->col);
+    int t = unit_index(plan->target);
+    if (t < 0 || g_units.hp[t] <= 0) return 0;
+    return strike(s, g_units.owner[t]);
+}
+
+static void apply_plan(const AiPlan *plan, void *user) {
+    (void)user;
+    follow_plan(plan);
+}
+
+/* --ai: plan team AI_FACTION in time slices, as the game does across frames */
+static void run_ai_turn(void) {
+    double t0 = timing_now_ms();
+    ai_begin_turn(&s_ai_planner, AI_FACTION);
+    while (!ai_plan_step(&s_ai_planner, AI_FRAME_BUDGET_MS, apply_plan, NULL)) {}
+    s_stats.ai_ms += timing_now_ms() - t0;
+}
+
+/* One action of `s`: attack an adjacent enemy or close in on the nearest one.
+ * Returns 1 if a cast was started (see strike), -1 when no enemy is left. */
+static int unit_step(Sprite *s) {
+    if (s_ai && SPRITE_FIELD(s, faction) == AI_FACTION) {
+        double t0 = timing_now_ms();
+        AiPlan plan;
+        int cast = ai_plan_unit(s->unit, &plan, &s_ai_planner.evaluated) ? follow_plan(&plan) : 0;
+        s_stats.ai_ms += timing_now_ms() - t0;
+        return cast;
+    }
+    int e = nearest_enemy(unit_index(s->unit));
+    if (e < 0) return -1;
+    Sprite *t = g_units.owner[e];
+    if (!adjacent(s, t)) move_sprite(s, SPRITE_FIELD(t, x), SPRITE_FIELD(t, y), 1);
+    if (!adjacent(s, t)) return 0;
+    return strike(s, t);
+}
+
+/* --ct: handle scheduler events for one turn's worth of battle time */
+static void run_ct_turn(void) {
+    if (s_turnq.count == 0) {
+        for (int u = 0; u < s_unit_count; ++u) turnq_schedule(&s_turnq, s_units[u]->unit, -1);
+    }
+    int64_t end = s_turnq.now - s_turnq.now % TURN_BASE_MS + TURN_BASE_MS;
+    TurnEvent ev;
+    int64_t next;
+    /* peek skips stale events, so the popped event is the one peeked */
+    while ((next = turnq_peek_time(&s_turnq)) >= 0 && next < end && turnq_pop(&s_turnq, &ev)) {
+        int k = unit_index(ev.unit);
+        Sprite *s = g_units.owner[k];
+        if (g_units.hp[k] <= 0) continue; /* fallen units drop out of the order */
+        if (ev.kind == TURN_CAST) {
+            /* the spell lands if the target is still alive and in reach */
+            int t = unit_index((UnitId)ev.data);
+            if (t >= 0 && g_units.hp[t] > 0 && adjacent(s, g_units.owner[t])) attack_sprite(s, g_units.owner[t]);
+            turnq_schedule(&s_turnq, ev.unit, -1);
+        } else if (unit_step(s) == 0) {
+            turnq_schedule(&s_turnq, ev.unit, -1);
+        }
+        /* a started cast reschedules the unit when it resolves */
+    }
+    s_turnq.now = end;
+}
+
+/* --fov: bring every living unit's view and both teams' fog up to date */
+static void refresh_fov(void) {
+    double t0 = timing_now_ms();
+    fog_update(0);
+    fog_update(1);
+    for (int u = 0; u < s_unit_count; ++u) {
+        if (unit_alive(u)) s_stats.fov_refreshes++;
+    }
+    s_stats.fov_ms += timing_now_ms() - t0;
+}
+
+/* one skirmish turn: every living unit attacks an adjacent enemy or closes in on the nearest one.
+ * Units belong to two factions by index parity. Returns 0 once a team is wiped out. */
+static int run_turn(void) {
+    double t0 = timing_now_ms();
+    if (s_ct) {
+        run_ct_turn();
+    } else {
+        for (int u = 0; u < s_unit_count; ++u) {
+            if (s_ai && SPRITE_FIELD(s_units[u], faction) == AI_FACTION) continue;
+            if (unit_alive(u) && unit_step(s_units[u]) < 0) break;
+        }
+        if (s_ai) run_ai_turn();
+    }
+    flush_attacks();
+    s_stats.turn_ms += timing_now_ms() - t0;
+    s_stats.turns++;
+    if (s_fov) refresh_fov();
+    return team_alive(0) && team_alive(1);
+}
+
+static void run_turns(int n) {
+    for (int i = 0; i < n; ++i) {
+        if (!s_quiet) printf("Turn %d\n", s_stats.turns + 1);
+        if (!run_turn()) break;
+    }
+}
+
+static int run_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Failed to open script '%s'\n", path);
+        return 0;
+    }
+    char line[256];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char cmd[32];
+        int a = 0, b = 0, c = 0;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        if (sscanf(line, "%31s", cmd) != 1) continue;
+        if (strcmp(cmd, "move") == 0 && sscanf(line, "%*s %d %d %d", &a, &b, &c) == 3) {
+            if (unit_alive(a)) move_unit(a, b, c, 0);
+        } else if (strcmp(cmd, "attack") == 0 && sscanf(line, "%*s %d %d", &a, &b) == 2) {
+            attack_unit(a, b);
+        } else if (strcmp(cmd, "turns") == 0 && sscanf(line, "%*s %d", &a) == 1) {
+            run_turns(a);
+        } else {
+            fprintf(stderr, "%s:%d: unrecognized command\n", path, lineno);
+        }
+    }
+    fclose(f);
+    return 1;
+}
+
+/* Monte Carlo duel of the first unit of each team, on all CPUs */
+static void run_estimate(int trials) {
+    SimUnit a, b;
+    battlesim_unit_from_sprite(s_units[0], &a);
+    battlesim_unit_from_sprite(s_units[1], &b);
+    ThreadPool *pool = threadpool_create(0);
+    BattleOutcome o;
+    double t0 = timing_now_ms();
+    battlesim_estimate(&a, &b, trials, rng_next(rng_stream(RNG_STREAM_AI)), pool, &o);
+    double ms = timing_now_ms() - t0;
+    printf("=== Estimate: %s vs %s ===\n", s_units[0]->name, s_units[1]->name);
+    printf("trials: %d in %.3f ms on %d threads\n", o.trials, ms, threadpool_size(pool));
+    printf("win rate: %.3f (wins %d, losses %d, draws %d)\n", o.win_rate_a, o.wins_a, o.wins_b, o.draws);
+    printf("rounds to kill: %.2f avg\n", o.mean_rounds);
+    printf("HP left: %.1f vs %.1f avg\n", o.mean_hp_a, o.mean_hp_b);
+    threadpool_destroy(pool);
+}
+
+static void print_report(void) {
+    int cells = g_map_rows * g_map_cols;
+    int alive[2] = {0, 0};
+    for (int i = 0; i < s_unit_count; ++i) if (unit_alive(i)) alive[i % 2]++;
+    printf("=== Headless report ===\n");
+    printf("map: %dx%d (%d cells), units: %d\n", g_map_rows, g_map_cols, cells, s_unit_count);
+    printf("worldgen: %.3f ms (%.1f ns/cell)\n", s_stats.worldgen_ms,
+           cells > 0 ? s_stats.worldgen_ms * 1e6 / cells : 0.0);
+    printf("paths: %d in %.3f ms (%.3f ms avg)\n", s_stats.paths, s_stats.path_ms,
+           s_stats.paths > 0 ? s_stats.path_ms / s_stats.paths : 0.0);
+    printf("attacks: %d in %.3f ms (%.3f us avg)\n", s_stats.attacks, s_stats.attack_ms,
+           s_stats.attacks > 0 ? s_stats.attack_ms * 1000.0 / s_stats.attacks : 0.0);
+    printf("turns: %d in %.3f ms\n", s_stats.turns, s_stats.turn_ms);
+    if (s_ai) {
+        printf("ai: %d plans, %ld candidates in %.3f ms (%d slices)\n", s_stats.ai_plans,
+               s_ai_planner.evaluated, s_stats.ai_ms, s_ai_planner.slices);
+    }
+    if (s_fov) {
+        printf("fov: %ld refreshes, %ld recomputed in %.3f ms\n", s_stats.fov_refreshes,
+               fov_recompute_count(), s_stats.fov_ms);
+        printf("fog: explored team0=%ld team1=%ld of %d cells\n", fog_explored_count(0), fog_explored_count(1), cells);
+    }
+    printf("survivors: team0=%d team1=%d\n", alive[0], alive[1]);
+}
+
+int main(int argc, char* argv[]) {
+    int units = DEFAULT_UNITS;
+    int turns = DEFAULT_TURNS;
+    const char *script = NULL;
+    int estimate = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--units") == 0 && i + 1 < argc) units = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--turns") == 0 && i + 1 < argc) turns = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) script = argv[++i];
+        else if (strcmp(argv[i], "--batch") == 0) s_batch = 1;
+        else if (strcmp(argv[i], "--ct") == 0) s_ct = 1;
+        else if (strcmp(argv[i], "--fov") == 0) s_fov = 1;
+        else if (strcmp(argv[i], "--ai") == 0) s_ai = 1;
+        else if (strcmp(argv[i], "--estimate") == 0 && i + 1 < argc) estimate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--quiet") == 0) s_quiet = 1;
+        else {
+            fprintf(stderr, "usage: %s [--units N] [--turns N] [--script FILE] [--batch] [--ct] [--fov] [--ai] [--estimate N] [--quiet]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (units < 2) units = 2;
+
+    config_init();
+    /* combat rules (built-in defaults if the file is missing) */
+    if (combat_rules_load(config_get_rules_path()) < 0) {
+        fprintf(stderr, "Combat rules %s not found, using defaults\n", config_get_rules_path());
+    }
+    unsigned int seed = world_seed_from_config();
+    printf("World seed: %u\n", seed);
+    double t0 = timing_now_ms();
+    if (world_generate(config_get_map_rows(), config_get_map_cols()) != 0) {
+        fprintf(stderr, "Failed to allocate terrain map %dx%d\n", config_get_map_rows(), config_get_map_cols());
+        return 1;
+    }
+    s_stats.worldgen_ms = timing_now_ms() - t0;
+    if (spatial_init(g_map_rows, g_map_cols) != 0) {
+        fprintf(stderr, "Failed to allocate the unit index\n");
+        return 1;
+    }
+    if (s_fov && fog_init(g_map_rows, g_map_cols) != 0) {
+        fprintf(stderr, "Failed to allocate fog of war\n");
+        return 1;
+    }
+
+    s_units = calloc(units, sizeof(Sprite*));
+    if (!s_units) return 1;
+    Rng *spawn_rng = rng_stream(RNG_STREAM_WORLDGEN);
+    for (int i = 0; i < units; ++i) {
+        s_units[i] = spawn_unit(i, spawn_rng);
+        if (!s_units[i]) { fprintf(stderr, "Failed to create unit %d\n", i); return 1; }
+        s_unit_count++;
+    }
+
+    if (estimate > 0) run_estimate(estimate);
+    if (script) {
+        if (!run_script(script)) return 1;
+    } else {
+        run_turns(turns);
+    }
+    print_report();
+
+    for (int i = 0; i < s_unit_count; ++i) sprite_destroy(s_units[i]);
+    free(s_units);
+    combat_batch_free(&s_combat_batch);
+    turnq_free(&s_turnq);
+    ai_free(&s_ai_planner);
+    fog_free();
+    fov_clear();
+    spatial_free();
+    units_clear();
+    sprite_pool_clear();
+    intern_clear();
+    path_cleanup();
+    world_free();
+    config_free();
+    return 0;
+}
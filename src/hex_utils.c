@@ -1,4 +1,6 @@
 #include <stdlib.h>
+#include <math.h>
+#include "hex_utils.h"
 
 /* Convert odd-q coordinates to cube coords for distance heuristic */
 static inline void oddq_to_cube(int col, int row, int *x, int *y, int *z) {
@@ -15,3 +17,139 @@ int hex_distance_cells(int r1, int c1, int r2, int c2) {
     int dx = abs(x1 - x2), dy = abs(y1 - y2), dz = abs(z1 - z2);
     return (dx + dy + dz) / 2;
 }
+
+void hex_distance_batch(int row, int col, const int* rows, const int* cols, int n, int* out) {
+    int q0 = col, r0 = row - (col - (col & 1)) / 2;
+    for (int i = 0; i < n; ++i) {
+        int q = cols[i];
+        int dq = q - q0;
+        int dr = rows[i] - (q - (q & 1)) / 2 - r0;
+        int ds = -dq - dr;
+        int aq = dq < 0 ? -dq : dq, ar = dr < 0 ? -dr : dr, as = ds < 0 ? -ds : ds;
+        out[i] = (aq + ar + as) / 2;
+    }
+}
+
+int hex_range_size(int radius) {
+    return radius < 0 ? 0 : 3 * radius * (radius + 1) + 1;
+}
+
+/* axial (q,r) steps in ring-walk order; offset row = r + (q - (q&1)) / 2 */
+static const int HEX_DIR_Q[6] = { 1, 1, 0, -1, -1, 0 };
+static const int HEX_DIR_R[6] = { 0, -1, -1, 0, 1, 1 };
+
+int hex_ring(int row, int col, int radius, int rows, int cols, int* out_r, int* out_c, int max) {
+    if (radius < 0) return 0;
+    int n = 0;
+    if (radius == 0) {
+        if (row >= 0 && row < rows && col >= 0 && col < cols) {
+            if (n < max) { out_r[n] = row; out_c[n] = col; }
+            ++n;
+        }
+        return n;
+    }
+    /* start `radius` steps along direction 4, then walk the six sides */
+    int q = col + HEX_DIR_Q[4] * radius;
+    int r = row - (col - (col & 1)) / 2 + HEX_DIR_R[4] * radius;
+    for (int side = 0; side < 6; ++side) {
+        for (int step = 0; step < radius; ++step) {
+            int orow = r + (q - (q & 1)) / 2;
+            if (orow >= 0 && orow < rows && q >= 0 && q < cols) {
+                if (n < max) { out_r[n] = orow; out_c[n] = q; }
+                ++n;
+            }
+            q += HEX_DIR_Q[side];
+            r += HEX_DIR_R[side];
+        }
+    }
+    return n;
+}
+
+/* In each column the cells in range form one contiguous run of rows, so the
+ * range is emitted as clipped row spans without any distance tests. */
+int hex_range(int row, int col, int radius, int rows, int cols, int* out_r, int* out_c, int max) {
+    if (radius < 0) return 0;
+    int r0 = row - (col - (col & 1)) / 2;
+    int c_lo = col - radius < 0 ? 0 : col - radius;
+    int c_hi = col + radius >= cols ? cols - 1 : col + radius;
+    int n = 0;
+    for (int q = c_lo; q <= c_hi; ++q) {
+        int dq = q - col;
+        int dr_lo = -dq - radius > -radius ? -dq - radius : -radius;
+        int dr_hi = -dq + radius < radius ? -dq + radius : radius;
+        int shift = (q - (q & 1)) / 2;
+        int lo = r0 + dr_lo + shift, hi = r0 + dr_hi + shift;
+        if (lo < 0) lo = 0;
+        if (hi >= rows) hi = rows - 1;
+        for (int r = lo; r <= hi; ++r) {
+            if (n < max) { out_r[n] = r; out_c[n] = q; }
+            ++n;
+        }
+    }
+    return n;
+}
+
+/* nearest cube cell to a fractional cube point; returns axial (q,r) */
+static void cube_round(double x, double y, double z, int* q, int* r) {
+    double rx = round(x), ry = round(y), rz = round(z);
+    double dx = fabs(rx - x), dy = fabs(ry - y), dz = fabs(rz - z);
+    if (dx > dy && dx > dz) rx = -ry - rz;
+    else if (dy <= dz) rz = -rx - ry;
+    *q = (int)rx; *r = (int)rz;
+}
+
+int hex_line(int r1, int c1, int r2, int c2, int* out_r, int* out_c, int max) {
+    int x1, y1, z1, x2, y2, z2;
+    oddq_to_cube(c1, r1, &x1, &y1, &z1);
+    oddq_to_cube(c2, r2, &x2, &y2, &z2);
+    int n = hex_distance_cells(r1, c1, r2, c2);
+    for (int i = 0; i <= n && i < max; ++i) {
+        double t = n > 0 ? (double)i / n : 0.0;
+        /* nudge off cell edges so rounding never lands on a tie */
+        double x = x1 + (x2 - x1) * t + 1e-6;
+        double y = y1 + (y2 - y1) * t + 2e-6;
+        double z = z1 + (z2 - z1) * t - 3e-6;
+        int q, r;
+        cube_round(x, y, z, &q, &r);
+        out_c[i] = q;
+        out_r[i] = r + (q - (q & 1)) / 2;
+    }
+    return n + 1;
+}
+
+void hex_layout_center(int row, int col, int radius, int* x, int* y) {
+    *x = col * (radius * 3 / 2) + radius;
+    *y = row * (radius * sqrt(3)) + radius;
+    if (col % 2) {
+        *y += radius * sqrt(3) / 2;
+    }
+}
+
+/* Hexes are the Voronoi cells of their centers, so the nearest center among
+ * the few candidates around the estimated column/row wins. */
+int hex_pick(int px, int py, int radius, int rows, int cols, int* out_row, int* out_col) {
+    if (radius < 1 || rows <= 0 || cols <= 0) return 0;
+    int step_x = radius * 3 / 2;
+    if (step_x < 1) step_x = 1;
+    double step_y = radius * sqrt(3);
+    int c_est = (int)floor((double)(px - radius) / step_x + 0.5);
+    long best = -1;
+    int best_r = -1, best_c = -1;
+    for (int c = c_est - 1; c <= c_est + 1; ++c) {
+        if (c < 0 || c >= cols) continue;
+        double off = (c % 2) ? step_y / 2 : 0.0;
+        int r_est = (int)floor((py - radius - off) / step_y + 0.5);
+        for (int r = r_est - 1; r <= r_est + 1; ++r) {
+            if (r < 0 || r >= rows) continue;
+            int cx, cy;
+            hex_layout_center(r, c, radius, &cx, &cy);
+            long dx = px - cx, dy = py - cy;
+            long d = dx * dx + dy * dy;
+            if (best < 0 || d < best) { best = d; best_r = r; best_c = c; }
+        }
+    }
+    /* points beyond the map edge are nearest to a border cell but outside its hex */
+    if (best < 0 || best > (long)radius * radius) return 0;
+    *out_row = best_r; *out_col = best_c;
+    return 1;
+}
@@ -7,6 +7,39 @@ extern "C" {
 
 int hex_distance_cells(int r1, int c1, int r2, int c2);
 
+/* Distances from (row,col) to n cells given as parallel row/col arrays,
+ * written to out[0..n). A plain loop with no calls so it vectorizes. */
+void hex_distance_batch(int row, int col, const int* rows, const int* cols, int n, int* out);
+
+/* Number of cells within distance `radius` of a cell on an unbounded map. */
+int hex_range_size(int radius);
+
+/* Cells at exactly distance `radius` from (row,col), walked around the ring
+ * and clipped to a rows x cols map. Writes up to `max` cells to out_r/out_c
+ * and returns how many are on the map (possibly more than `max`). */
+int hex_ring(int row, int col, int radius, int rows, int cols, int* out_r, int* out_c, int max);
+
+/* Cells within distance `radius` of (row,col), column by column, clipped to
+ * the map. Same output convention as hex_ring. */
+int hex_range(int row, int col, int radius, int rows, int cols, int* out_r, int* out_c, int max);
+
+/* Cells on the straight line from (r1,c1) to (r2,c2), both ends included,
+ * each one step from the previous. Writes up to `max` cells and returns the
+ * line length (hex distance + 1). Ties on cell edges are broken by a fixed
+ * nudge, so a given pair always yields the same line. */
+int hex_line(int r1, int c1, int r2, int c2, int* out_r, int* out_c, int max);
+
+/* Pixel center of cell (row,col) in the odd-q flat-top layout, relative to the
+ * map origin (no margin or camera offset).
+ */
+void hex_layout_center(int row, int col, int radius, int* x, int* y);
+
+/* Cell whose hex contains the origin-relative point (px,py), found directly
+ * from the layout instead of testing every cell. Returns 0 and leaves
+ * row/col untouched when the point is outside a rows x cols map.
+ */
+int hex_pick(int px, int py, int radius, int rows, int cols, int* out_row, int* out_col);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,72 @@
+/* intern.c - interned string table */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "intern.h"
+#include "pool.h"
+
+/* open-addressed table of string pointers; the text lives in the arena */
+static const char **s_table = NULL;
+static uint32_t *s_hashes = NULL;
+static int s_cap = 0, s_count = 0;
+static Arena s_arena = ARENA_INIT(16384);
+
+static uint32_t str_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)s; *p; ++p) { h ^= *p; h *= 16777619u; }
+    return h;
+}
+
+/* keep the load factor at or below 1/2 */
+static int table_grow(void) {
+    int cap = s_cap ? s_cap * 2 : 256;
+    const char **table = calloc(cap, sizeof(*table));
+    uint32_t *hashes = malloc(sizeof(*hashes) * cap);
+    if (!table || !hashes) { free(table); free(hashes); return -1; }
+    for (int i = 0; i < s_cap; ++i) {
+        if (!s_table[i]) continue;
+        int j = s_hashes[i] & (cap - 1);
+        while (table[j]) j = (j + 1) & (cap - 1);
+        table[j] = s_table[i];
+        hashes[j] = s_hashes[i];
+    }
+    free(s_table);
+    free(s_hashes);
+    s_table = table;
+    s_hashes = hashes;
+    s_cap = cap;
+    return 0;
+}
+
+const char *str_intern(const char *s) {
+    if (!s) return NULL;
+    if ((s_count + 1) * 2 > s_cap && table_grow() != 0) return NULL;
+    uint32_t h = str_hash(s);
+    int i = h & (s_cap - 1);
+    while (s_table[i]) {
+        if (s_hashes[i] == h && strcmp(s_table[i], s) == 0) return s_table[i];
+        i = (i + 1) & (s_cap - 1);
+    }
+    size_t n = strlen(s) + 1;
+    char *copy = arena_alloc(&s_arena, n);
+    if (!copy) return NULL;
+    memcpy(copy, s, n);
+    s_table[i] = copy;
+    s_hashes[i] = h;
+    s_count++;
+    return copy;
+}
+
+int intern_count(void) {
+    return s_count;
+}
+
+void intern_clear(void) {
+    free(s_table);
+    free(s_hashes);
+    s_table = NULL;
+    s_hashes = NULL;
+    s_cap = s_count = 0;
+    arena_destroy(&s_arena);
+}
@@ -0,0 +1,26 @@
+/* intern.h - interned string table */
+#ifndef INTERN_H
+#define INTERN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Canonical copy of `s`: equal strings give the same pointer, which stays
+ * valid until intern_clear. NULL in gives NULL out (also when out of memory).
+ * Interned strings are never freed one by one, so use this for the small,
+ * repeating set of names, job titles and image keys rather than free text.
+ */
+const char *str_intern(const char *s);
+
+/* number of distinct strings held */
+int intern_count(void);
+
+/* Drop every interned string; all pointers handed out become invalid */
+void intern_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INTERN_H */
@@ -2,29 +2,37 @@
 
 #include "job.h"
 
+static const JobInfo s_jobs[JOB_COUNT] = {
+    { "Warrior", "战士",     ATTACK_MODE_PHYSICAL, 5 },
+    { "Mage",    "法师",     ATTACK_MODE_MAGIC,    6 },
+    { "Rogue",   "盗贼",     ATTACK_MODE_PHYSICAL, 6 },
+    { "Cleric",  "牧师",     ATTACK_MODE_MAGIC,    5 },
+    { "Archer",  "弓箭手",   ATTACK_MODE_PHYSICAL, 8 },
+};
+
+const JobInfo* job_info(JobType job) {
+    if ((int)job < 0 || job >= JOB_COUNT) job = JOB_WARRIOR;
+    return &s_jobs[job];
+}
+
 JobType get_job_type(const char* job_name) {
     if (!job_name) return JOB_WARRIOR;
     
-    if (strstr(job_name, "Warrior") || strstr(job_name, "战士")) return JOB_WARRIOR;
-    if (strstr(job_name, "Mage") || strstr(job_name, "法师")) return JOB_MAGE;
-    if (strstr(job_name, "Rogue") || strstr(job_name, "盗贼")) return JOB_ROGUE;
-    if (strstr(job_name, "Cleric") || strstr(job_name, "牧师")) return JOB_CLERIC;
-    if (strstr(job_name, "Archer") || strstr(job_name, "弓箭手")) return JOB_ARCHER;
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        if (strstr(job_name, s_jobs[i].name) || strstr(job_name, s_jobs[i].name_zh)) return (JobType)i;
+    }
     
     return JOB_WARRIOR;
 }
 
+int job_attack_mode(JobType job) {
+    return job_info(job)->attack_mode;
+}
+
+int job_sight(JobType job) {
+    return job_info(job)->sight;
+}
+
 int get_attack_mode(const char* job_name) {
-    JobType job_type = get_job_type(job_name);
-    switch (job_type) {
-        case JOB_WARRIOR:
-        case JOB_ROGUE:
-        case JOB_ARCHER:
-            return ATTACK_MODE_PHYSICAL;
-        case JOB_MAGE:
-        case JOB_CLERIC:
-            return ATTACK_MODE_MAGIC;
-        default:
-            return ATTACK_MODE_PHYSICAL;
-    }
+    return job_attack_mode(get_job_type(job_name));
 }
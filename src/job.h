@@ -10,17 +10,34 @@ typedef enum {
     JOB_MAGE,           // Mage: Strong magic attacks
     JOB_ROGUE,          // Rogue: High critical hit chance
     JOB_CLERIC,         // Cleric: Healing and support
-    JOB_ARCHER          // Archer: Ranged attacks
+    JOB_ARCHER,         // Archer: Ranged attacks
+    JOB_COUNT
 } JobType;
 
 typedef enum {
     ATTACK_MODE_NONE = 0,
     ATTACK_MODE_PHYSICAL,
-    ATTACK_MODE_MAGIC
+    ATTACK_MODE_MAGIC,
+    ATTACK_MODE_COUNT
 } AttackMode;
 
+/* Job names, default attack mode and sight radius. Sprites resolve their JobType once (on
+ * create and sprite_set_job); per-job combat modifiers live in the combat
+ * rules table (combat.h), indexed by JobType. */
+typedef struct {
+    const char* name;       /* English name, matched as a substring */
+    const char* name_zh;    /* Chinese name, matched as a substring */
+    int attack_mode;        /* AttackMode used by the job */
+    int sight;              /* field-of-view radius in cells */
+} JobInfo;
+
+const JobInfo* job_info(JobType job);
+
+/* string lookups; unknown names fall back to JOB_WARRIOR */
 JobType get_job_type(const char* job_name);
 int get_attack_mode(const char* job_name);
+int job_attack_mode(JobType job);
+int job_sight(JobType job);
 
 #if defined(__cplusplus)
 }
@@ -0,0 +1,70 @@
+/* mapimage.c - downsampled terrain image for zoomed-out views */
+#include "fog.h"
+#include "mapimage.h"
+#include "world.h"
+
+void mapimage_dims(int rows, int cols, int max_dim, int* out_w, int* out_h, int* out_step) {
+    int half_rows = rows * 2 + 1;
+    int longest = cols > half_rows ? cols : half_rows;
+    if (max_dim < 1) max_dim = 1;
+    int step = (longest + max_dim - 1) / max_dim;
+    if (step < 1) step = 1;
+    *out_step = step;
+    *out_w = (cols + step - 1) / step;
+    *out_h = (half_rows + step - 1) / step;
+}
+
+void mapimage_fill(uint32_t* pixels, int pitch_px, int w, int h, int step,
+                   const uint32_t palette[TERRAIN_COUNT], uint32_t empty) {
+    mapimage_fill_rect(pixels, pitch_px, 0, 0, w, h, step, palette, empty);
+}
+
+void mapimage_apply_fog(uint32_t* pixels, int pitch_px, int w, int h, int step, int faction, uint32_t hidden) {
+    mapimage_apply_fog_rect(pixels, pitch_px, 0, 0, w, h, step, faction, hidden);
+}
+
+void mapimage_fill_rect(uint32_t* pixels, int pitch_px, int x, int y, int w, int h, int step,
+                        const uint32_t palette[TERRAIN_COUNT], uint32_t empty) {
+    for (int ty = 0; ty < h; ++ty) {
+        uint32_t* line = pixels + (size_t)ty * pitch_px;
+        int half_row = (y + ty) * step;
+        for (int tx = 0; tx < w; ++tx) {
+            int col = (x + tx) * step;
+            /* odd columns are shifted down by half a cell */
+            int row = (half_row - (col & 1)) >> 1;
+            if (col >= g_map_cols || row < 0 || row >= g_map_rows) { line[tx] = empty; continue; }
+            Terrain t = TERRAIN_AT(row, col);
+            line[tx] = (t >= 0 && t < TERRAIN_COUNT) ? palette[t] : empty;
+        }
+    }
+}
+
+void mapimage_apply_fog_rect(uint32_t* pixels, int pitch_px, int x, int y, int w, int h, int step,
+                             int faction, uint32_t hidden) {
+    if (!fog_enabled()) return;
+    for (int ty = 0; ty < h; ++ty) {
+        uint32_t* line = pixels + (size_t)ty * pitch_px;
+        int half_row = (y + ty) * step;
+        for (int tx = 0; tx < w; ++tx) {
+            int col = (x + tx) * step;
+            int row = (half_row - (col & 1)) >> 1;
+            if (col >= g_map_cols || row < 0 || row >= g_map_rows) continue;
+            if (!fog_explored(faction, row, col)) line[tx] = hidden;
+        }
+    }
+}
+
+void mapimage_cells_rect(int row_lo, int row_hi, int col_lo, int col_hi, int step, int img_w, int img_h,
+                         int* out_x, int* out_y, int* out_w, int* out_h) {
+    if (step < 1) step = 1;
+    /* cell (r,c) covers half-rows 2r+(c&1) and 2r+1+(c&1) */
+    int x0 = col_lo / step, x1 = col_hi / step;
+    int y0 = (2 * row_lo) / step, y1 = (2 * row_hi + 2) / step;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > img_w - 1) x1 = img_w - 1;
+    if (y1 > img_h - 1) y1 = img_h - 1;
+    *out_x = x0; *out_y = y0;
+    *out_w = x1 >= x0 ? x1 - x0 + 1 : 0;
+    *out_h = y1 >= y0 ? y1 - y0 + 1 : 0;
+}
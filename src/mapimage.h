@@ -0,0 +1,47 @@
+/* mapimage.h - downsampled terrain image for zoomed-out views */
+#ifndef MAPIMAGE_H
+#define MAPIMAGE_H
+
+#include <stdint.h>
+#include "path.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The image keeps the odd-q layout: each cell covers one texel column and two
+ * texel rows (half-rows), and odd columns start one half-row lower. With
+ * step > 1 every texel samples a step x step block of that grid, so a texel
+ * at (tx,ty) corresponds to column tx*step and half-row ty*step.
+ */
+
+/* Image size for a rows x cols map so neither side exceeds max_dim texels */
+void mapimage_dims(int rows, int cols, int max_dim, int* out_w, int* out_h, int* out_step);
+
+/* Fill a w x h image (pitch in pixels) from g_terrain_map. `palette` holds one
+ * pixel value per Terrain; `empty` is used for half-rows outside the map.
+ */
+void mapimage_fill(uint32_t* pixels, int pitch_px, int w, int h, int step,
+                   const uint32_t palette[TERRAIN_COUNT], uint32_t empty);
+
+/* Paint texels whose sampled cell `faction` has not explored (fog.h) with
+ * `hidden`; a no-op while fog is off. Same layout as mapimage_fill. */
+void mapimage_apply_fog(uint32_t* pixels, int pitch_px, int w, int h, int step, int faction, uint32_t hidden);
+
+/* Sub-rectangle versions for patching part of an image: `pixels` points at
+ * texel (x,y) and only the w x h texels from there are written. */
+void mapimage_fill_rect(uint32_t* pixels, int pitch_px, int x, int y, int w, int h, int step,
+                        const uint32_t palette[TERRAIN_COUNT], uint32_t empty);
+void mapimage_apply_fog_rect(uint32_t* pixels, int pitch_px, int x, int y, int w, int h, int step,
+                             int faction, uint32_t hidden);
+
+/* Texels of an img_w x img_h image that sample cells in rows row_lo..row_hi,
+ * columns col_lo..col_hi (clipped to the image); *out_w or *out_h is 0 if none. */
+void mapimage_cells_rect(int row_lo, int row_hi, int col_lo, int col_hi, int step, int img_w, int img_h,
+                         int* out_x, int* out_y, int* out_w, int* out_h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAPIMAGE_H */
@@ -5,29 +5,23 @@
 
 #include "hex_utils.h"
 #include "path.h"
-
-/* Access map data from main program */
-extern int g_map_rows;
-extern int g_map_cols;
-extern Terrain* g_terrain_map; /* flattened [r*cols + c] */
+#include "region.h"
+#include "world.h"
 
 int *path_nodes = NULL;
 int path_len = 0;
 unsigned char *in_path = NULL;
 int *prev_node = NULL;
 
-/* forward declare neighbor helper implemented in main.c */
-extern int get_neighbors(int r, int c, int *out_r, int *out_c);
-
 /* cost per terrain (integer) */
-static int terrain_cost_local(Terrain t) {
+int path_terrain_cost(Terrain t) {
     switch (t) {
         case TERRAIN_PLAINS: return 10;
         case TERRAIN_HILLS: return 30;
         case TERRAIN_FOREST: return 50;
         case TERRAIN_DESERT: return 20;
         case TERRAIN_WATER: return 100;
-        case TERRAIN_MOUNTAIN: return 10000;
+        case TERRAIN_MOUNTAIN: return PATH_IMPASSABLE_COST;
         default: return 10;
     }
 }
@@ -71,6 +65,16 @@ void compute_path(int sr, int sc, int tr, int tc) {
     int n = g_map_rows * g_map_cols;
     if (!prev_node) prev_node = malloc(sizeof(int)*n);
     if (!in_path) in_path = calloc(n,1);
+    /* goal in another connected component: reject without searching; only
+     * the cells of the previous path can be marked in `in_path` */
+    if (!region_reachable(sr, sc, tr, tc)) {
+        if (path_nodes) {
+            for (int i = 0; i < path_len; ++i) in_path[path_nodes[i]] = 0;
+            free(path_nodes); path_nodes = NULL;
+        }
+        path_len = 0;
+        return;
+    }
     int INF = 0x3f3f3f3f;
     int *gscore = malloc(sizeof(int)*n);
     for (int i = 0; i < n; ++i) { gscore[i] = INF; prev_node[i] = -1; in_path[i] = 0; }
@@ -97,8 +101,8 @@ void compute_path(int sr, int sc, int tr, int tc) {
         for (int i = 0; i < nc; ++i) {
             int vr = nbr_r[i], vc = nbr_c[i];
             int v = vr * g_map_cols + vc;
-            int w = terrain_cost_local(g_terrain_map[v]);
-            if (w >= 10000) continue;
+            int w = path_terrain_cost(g_terrain_map[v]);
+            if (w >= PATH_IMPASSABLE_COST) continue;
             int tentative_g = gscore[u] + w;
             if (tentative_g < gscore[v]) {
                 prev_node[v] = u;
@@ -18,6 +18,12 @@ typedef enum {
     TERRAIN_COUNT
 } Terrain;
 
+/* Cost at or above which a cell is never entered */
+#define PATH_IMPASSABLE_COST 10000
+
+/* Movement cost of entering a cell of terrain `t` */
+int path_terrain_cost(Terrain t);
+
 /* Path result buffers (owned by path.c) */
 extern int *path_nodes; /* ordered indices from start->end */
 extern int path_len;
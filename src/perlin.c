@@ -4,6 +4,7 @@
 #include <time.h>
 
 #include "perlin.h"
+#include "rng.h"
 
 static int perm_table[512];
 static PerlinParams g_params;
@@ -29,10 +30,11 @@ static float grad2(int hash, float x, float y) {
 static void perlin_init_perm(unsigned int seed) {
     int i;
     int src[256];
+    Rng rng;
     for (i = 0; i < 256; ++i) src[i] = i;
-    srand(seed);
+    rng_seed(&rng, seed, RNG_STREAM_PERLIN);
     for (i = 255; i > 0; --i) {
-        int j = rand() % (i + 1);
+        int j = rng_range(&rng, i + 1);
         int t = src[i]; src[i] = src[j]; src[j] = t;
     }
     for (i = 0; i < 256; ++i) {
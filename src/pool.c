@@ -0,0 +1,96 @@
+/* pool.c - fixed-size object pool and bump arena */
+#include <stdlib.h>
+
+#include "pool.h"
+
+#define ARENA_ALIGN (sizeof(void *) > sizeof(double) ? sizeof(void *) : sizeof(double))
+
+void pool_init(Pool *p, size_t elem_size, int per_block) {
+    p->elem_size = elem_size > sizeof(void *) ? elem_size : sizeof(void *);
+    p->per_block = per_block > 0 ? per_block : 64;
+    p->free_list = NULL;
+    p->blocks = NULL;
+    p->nblocks = p->blocks_cap = 0;
+    p->live = 0;
+}
+
+/* allocate one block and thread its objects onto the free list */
+static int pool_grow(Pool *p) {
+    if (p->nblocks == p->blocks_cap) {
+        int cap = p->blocks_cap ? p->blocks_cap * 2 : 8;
+        void **b = realloc(p->blocks, sizeof(void *) * cap);
+        if (!b) return -1;
+        p->blocks = b;
+        p->blocks_cap = cap;
+    }
+    size_t stride = (p->elem_size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    char *block = malloc(stride * p->per_block);
+    if (!block) return -1;
+    p->blocks[p->nblocks++] = block;
+    for (int i = p->per_block - 1; i >= 0; --i) {
+        void **obj = (void **)(block + stride * i);
+        *obj = p->free_list;
+        p->free_list = obj;
+    }
+    return 0;
+}
+
+void *pool_alloc(Pool *p) {
+    if (!p->free_list && pool_grow(p) != 0) return NULL;
+    void **obj = p->free_list;
+    p->free_list = *obj;
+    p->live++;
+    return obj;
+}
+
+void pool_free(Pool *p, void *obj) {
+    if (!obj) return;
+    *(void **)obj = p->free_list;
+    p->free_list = obj;
+    p->live--;
+}
+
+void pool_destroy(Pool *p) {
+    for (int i = 0; i < p->nblocks; ++i) free(p->blocks[i]);
+    free(p->blocks);
+    p->blocks = NULL;
+    p->nblocks = p->blocks_cap = 0;
+    p->free_list = NULL;
+    p->live = 0;
+}
+
+struct ArenaChunk {
+    ArenaChunk *next;
+    size_t used, size;
+    /* data follows, aligned to ARENA_ALIGN */
+};
+
+#define CHUNK_HEADER ((sizeof(ArenaChunk) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+void *arena_alloc(Arena *a, size_t size) {
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    ArenaChunk *c = a->head;
+    if (!c || c->size - c->used < size) {
+        size_t want = a->chunk_size ? a->chunk_size : 4096;
+        if (want < size) want = size; /* oversized requests get their own chunk */
+        c = malloc(CHUNK_HEADER + want);
+        if (!c) return NULL;
+        c->used = 0;
+        c->size = want;
+        c->next = a->head;
+        a->head = c;
+    }
+    void *p = (char *)c + CHUNK_HEADER + c->used;
+    c->used += size;
+    return p;
+}
+
+void arena_destroy(Arena *a) {
+    ArenaChunk *c = a->head;
+    while (c) {
+        ArenaChunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    a->head = NULL;
+}
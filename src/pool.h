@@ -0,0 +1,48 @@
+/* pool.h - fixed-size object pool and bump arena */
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Hands out objects of one size from blocks of `per_block` objects. Freed
+ * objects go on a free list and are reused before a new block is allocated,
+ * so steady alloc/free churn does no malloc traffic.
+ */
+typedef struct {
+    size_t elem_size;
+    int per_block;
+    void *free_list;
+    void **blocks;
+    int nblocks, blocks_cap;
+    int live;           /* objects currently handed out */
+} Pool;
+
+/* Use POOL_INIT(type, n) as an initializer, or pool_init at runtime */
+#define POOL_INIT(type, n) { (sizeof(type) > sizeof(void *) ? sizeof(type) : sizeof(void *)), (n), NULL, NULL, 0, 0, 0 }
+void pool_init(Pool *p, size_t elem_size, int per_block);
+void *pool_alloc(Pool *p);
+void pool_free(Pool *p, void *obj);
+/* release every block; all objects become invalid */
+void pool_destroy(Pool *p);
+
+/* Bump allocator: allocations live until arena_destroy */
+typedef struct ArenaChunk ArenaChunk;
+typedef struct {
+    ArenaChunk *head;
+    size_t chunk_size;
+} Arena;
+
+#define ARENA_INIT(chunk_size) { NULL, (chunk_size) }
+/* `size` bytes aligned for any scalar type; NULL if out of memory */
+void *arena_alloc(Arena *a, size_t size);
+void arena_destroy(Arena *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POOL_H */
@@ -0,0 +1,92 @@
+/* profiler.c - per-phase frame timers with rolling percentile stats */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profiler.h"
+#include "timing.h"
+
+typedef struct {
+    float window[PROFILER_WINDOW]; /* ring buffer of per-frame totals (ms) */
+    double started;                /* begin timestamp, 0 when not running */
+    double current;                /* accumulated time in the open frame */
+    double sum;
+    double max;
+} PhaseTimer;
+
+static PhaseTimer s_phases[PROF_PHASE_COUNT];
+static long s_frames = 0;
+static double s_last_frame_end = -1.0;
+
+static const char *s_phase_names[PROF_PHASE_COUNT] = {
+    "events", "update", "ai", "terrain", "overlays", "sprites", "ui", "present", "frame"
+};
+
+void profiler_begin(ProfPhase p) {
+    if ((int)p < 0 || p >= PROF_PHASE_COUNT) return;
+    s_phases[p].started = timing_now_ms();
+}
+
+void profiler_end(ProfPhase p) {
+    if ((int)p < 0 || p >= PROF_PHASE_COUNT) return;
+    PhaseTimer *t = &s_phases[p];
+    if (t->started <= 0.0) return;
+    t->current += timing_now_ms() - t->started;
+    t->started = 0.0;
+}
+
+void profiler_frame_end(void) {
+    double now = timing_now_ms();
+    if (s_last_frame_end > 0.0) s_phases[PROF_FRAME].current = now - s_last_frame_end;
+    s_last_frame_end = now;
+    int slot = (int)(s_frames % PROFILER_WINDOW);
+    for (int i = 0; i < PROF_PHASE_COUNT; ++i) {
+        PhaseTimer *t = &s_phases[i];
+        t->window[slot] = (float)t->current;
+        t->sum += t->current;
+        if (t->current > t->max) t->max = t->current;
+        t->current = 0.0;
+    }
+    s_frames++;
+}
+
+static int cmp_float(const void *a, const void *b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+void profiler_get_stats(ProfPhase p, ProfStats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if ((int)p < 0 || p >= PROF_PHASE_COUNT || s_frames == 0) return;
+    const PhaseTimer *t = &s_phases[p];
+    int n = s_frames < PROFILER_WINDOW ? (int)s_frames : PROFILER_WINDOW;
+    float sorted[PROFILER_WINDOW];
+    memcpy(sorted, t->window, sizeof(float) * n);
+    qsort(sorted, n, sizeof(float), cmp_float);
+    out->p50_ms = sorted[(n - 1) * 50 / 100];
+    out->p99_ms = sorted[(n - 1) * 99 / 100];
+    out->mean_ms = t->sum / s_frames;
+    out->max_ms = t->max;
+    out->frames = s_frames;
+}
+
+const char *profiler_phase_name(ProfPhase p) {
+    if ((int)p < 0 || p >= PROF_PHASE_COUNT) return "?";
+    return s_phase_names[p];
+}
+
+int profiler_write_csv(const char *path) {
+    if (!path || !path[0]) return -1;
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "phase,frames,mean_ms,p50_ms,p99_ms,max_ms\n");
+    for (int i = 0; i < PROF_PHASE_COUNT; ++i) {
+        ProfStats st;
+        profiler_get_stats((ProfPhase)i, &st);
+        fprintf(f, "%s,%ld,%.4f,%.4f,%.4f,%.4f\n", s_phase_names[i], st.frames,
+                st.mean_ms, st.p50_ms, st.p99_ms, st.max_ms);
+    }
+    fclose(f);
+    return 0;
+}
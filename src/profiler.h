@@ -0,0 +1,50 @@
+/* profiler.h - per-phase frame timers with rolling percentile stats */
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* number of most recent frames kept for percentiles */
+#define PROFILER_WINDOW 240
+
+typedef enum {
+    PROF_EVENTS = 0,   /* input/event handling */
+    PROF_UPDATE,       /* movement and animation */
+    PROF_AI,           /* enemy turn planning */
+    PROF_TERRAIN,      /* terrain hexes (and cell coordinates) */
+    PROF_OVERLAYS,     /* path, selection, attack range, hover */
+    PROF_SPRITES,      /* unit sprites */
+    PROF_UI,           /* menu and info panel */
+    PROF_PRESENT,      /* SDL_RenderPresent */
+    PROF_FRAME,        /* whole frame including idle time; filled by profiler_frame_end */
+    PROF_PHASE_COUNT
+} ProfPhase;
+
+typedef struct {
+    double p50_ms;
+    double p99_ms;
+    double mean_ms; /* over the whole run */
+    double max_ms;  /* over the whole run */
+    long frames;
+} ProfStats;
+
+/* start/stop timing a phase; a phase may be timed several times per frame */
+void profiler_begin(ProfPhase p);
+void profiler_end(ProfPhase p);
+
+/* close the current frame and push every phase total into the rolling window */
+void profiler_frame_end(void);
+
+void profiler_get_stats(ProfPhase p, ProfStats *out);
+const char *profiler_phase_name(ProfPhase p);
+
+/* write one line per phase (phase,frames,mean_ms,p50_ms,p99_ms,max_ms); returns 0 on success */
+int profiler_write_csv(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H */
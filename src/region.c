@@ -0,0 +1,132 @@
+/* region.c - connected-component labelling of passable terrain (union-find)
+ *
+ * The map is processed in horizontal bands of REGION_BAND_ROWS rows. Each band
+ * only links cells inside itself, so bands are independent of each other and
+ * can be labelled in parallel; the seams between bands are joined afterwards.
+ */
+#include <stdlib.h>
+
+#include "path.h"
+#include "region.h"
+#include "world.h"
+
+#define REGION_BAND_ROWS 64
+
+static int *s_label = NULL; /* parent links while building, component ids after */
+static int s_rows = 0, s_cols = 0;
+
+static int passable(int idx) {
+    return path_terrain_cost(g_terrain_map[idx]) < PATH_IMPASSABLE_COST;
+}
+
+/* roots are always the smallest index of their set, so parent[i] <= i holds */
+static int uf_find(int *parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+static void uf_union(int *parent, int a, int b) {
+    int ra = uf_find(parent, a), rb = uf_find(parent, b);
+    if (ra == rb) return;
+    if (ra < rb) parent[rb] = ra; else parent[ra] = rb;
+}
+
+/* link each passable cell of rows [r0,r1) to its passable neighbours in the same rows */
+static void label_band(int *parent, int r0, int r1) {
+    int nbr_r[6], nbr_c[6];
+    for (int r = r0; r < r1; ++r) {
+        for (int c = 0; c < g_map_cols; ++c) {
+            int u = r * g_map_cols + c;
+            if (parent[u] < 0) continue;
+            int nc = get_neighbors(r, c, nbr_r, nbr_c);
+            for (int i = 0; i < nc; ++i) {
+                if (nbr_r[i] < r0 || nbr_r[i] >= r1) continue;
+                int v = nbr_r[i] * g_map_cols + nbr_c[i];
+                if (v > u && parent[v] >= 0) uf_union(parent, u, v);
+            }
+        }
+    }
+}
+
+/* join row `r` (first row of a band) with the row above it */
+static void join_seam(int *parent, int r) {
+    int nbr_r[6], nbr_c[6];
+    for (int c = 0; c < g_map_cols; ++c) {
+        int u = r * g_map_cols + c;
+        if (parent[u] < 0) continue;
+        int nc = get_neighbors(r, c, nbr_r, nbr_c);
+        for (int i = 0; i < nc; ++i) {
+            if (nbr_r[i] != r - 1) continue;
+            int v = nbr_r[i] * g_map_cols + nbr_c[i];
+            if (parent[v] >= 0) uf_union(parent, u, v);
+        }
+    }
+}
+
+int region_build(void) {
+    int n = g_map_rows * g_map_cols;
+    region_cleanup();
+    if (n <= 0 || !g_terrain_map) return -1;
+    int *parent = malloc(sizeof(int) * n);
+    if (!parent) return -1;
+    for (int i = 0; i < n; ++i) parent[i] = passable(i) ? i : -1;
+
+    for (int r0 = 0; r0 < g_map_rows; r0 += REGION_BAND_ROWS) {
+        int r1 = r0 + REGION_BAND_ROWS;
+        if (r1 > g_map_rows) r1 = g_map_rows;
+        label_band(parent, r0, r1);
+    }
+    for (int r = REGION_BAND_ROWS; r < g_map_rows; r += REGION_BAND_ROWS) {
+        join_seam(parent, r);
+    }
+
+    /* point every cell straight at its root (parents precede children) ... */
+    for (int i = 0; i < n; ++i) {
+        if (parent[i] >= 0) parent[i] = parent[parent[i]];
+    }
+    /* ... then replace roots by compact component ids in scan order */
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (parent[i] < 0) continue;
+        parent[i] = (parent[i] == i) ? count++ : parent[parent[i]];
+    }
+
+    s_label = parent;
+    s_rows = g_map_rows;
+    s_cols = g_map_cols;
+    return count;
+}
+
+static int labels_valid(void) {
+    return s_label && s_rows == g_map_rows && s_cols == g_map_cols;
+}
+
+int region_label_at(int r, int c) {
+    if (!labels_valid()) return -1;
+    if (r < 0 || r >= s_rows || c < 0 || c >= s_cols) return -1;
+    return s_label[r * s_cols + c];
+}
+
+int region_reachable(int sr, int sc, int tr, int tc) {
+    if (!labels_valid()) return 1;
+    if (sr == tr && sc == tc) return 1;
+    int lt = region_label_at(tr, tc);
+    if (lt < 0) return 0; /* goal is never entered */
+    int ls = region_label_at(sr, sc);
+    if (ls >= 0) return ls == lt;
+    /* start on an impassable cell: the search may still step off it */
+    int nbr_r[6], nbr_c[6];
+    int nc = get_neighbors(sr, sc, nbr_r, nbr_c);
+    for (int i = 0; i < nc; ++i) {
+        if (region_label_at(nbr_r[i], nbr_c[i]) == lt) return 1;
+    }
+    return 0;
+}
+
+void region_cleanup(void) {
+    if (s_label) { free(s_label); s_label = NULL; }
+    s_rows = s_cols = 0;
+}
@@ -0,0 +1,30 @@
+/* region.h - connected components of passable terrain */
+#ifndef REGION_H
+#define REGION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Label every passable cell of `g_terrain_map` with the id of its connected
+ * component. Call once after world generation (and again if terrain changes).
+ * Returns the number of components, or -1 on allocation failure.
+ */
+int region_build(void);
+
+/* component id of cell (r,c); -1 for impassable cells or when not built */
+int region_label_at(int r, int c);
+
+/* non-zero if a path from (sr,sc) to (tr,tc) may exist. Always non-zero when
+ * labels have not been built, so callers can use it unconditionally.
+ */
+int region_reachable(int sr, int sc, int tr, int tc);
+
+/* Free the label map */
+void region_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REGION_H */
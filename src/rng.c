@@ -0,0 +1,50 @@
+/* rng.c - PCG32 (XSH-RR) generator, see pcg-random.org */
+#include "rng.h"
+
+#define PCG_MULT 6364136223846793005ULL
+
+static Rng s_streams[RNG_STREAM_COUNT];
+static int s_streams_seeded = 0;
+
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream) {
+    if (!r) return;
+    r->state = 0;
+    r->inc = (stream << 1u) | 1u;
+    rng_next(r);
+    r->state += seed;
+    rng_next(r);
+}
+
+uint32_t rng_next(Rng *r) {
+    uint64_t old = r->state;
+    r->state = old * PCG_MULT + r->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = (uint32_t)(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+int rng_range(Rng *r, int n) {
+    if (n <= 0) return 0;
+    /* multiply-shift reduction: no division, bias below 2^-32 * n */
+    return (int)(((uint64_t)rng_next(r) * (uint32_t)n) >> 32);
+}
+
+int rng_between(Rng *r, int lo, int hi) {
+    if (hi <= lo) return lo;
+    return lo + rng_range(r, hi - lo + 1);
+}
+
+float rng_float(Rng *r) {
+    return (rng_next(r) >> 8) * (1.0f / 16777216.0f);
+}
+
+void rng_init_streams(uint64_t seed) {
+    for (int i = 0; i < RNG_STREAM_COUNT; ++i) rng_seed(&s_streams[i], seed, (uint64_t)i);
+    s_streams_seeded = 1;
+}
+
+Rng *rng_stream(RngStream s) {
+    if (!s_streams_seeded) rng_init_streams(0);
+    if ((int)s < 0 || s >= RNG_STREAM_COUNT) s = RNG_STREAM_WORLDGEN;
+    return &s_streams[s];
+}
@@ -0,0 +1,52 @@
+/* rng.h - small seedable PRNG (PCG32) with independent streams */
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t state;
+    uint64_t inc; /* stream selector, always odd */
+} Rng;
+
+/* process-wide streams; each subsystem draws only from its own */
+typedef enum {
+    RNG_STREAM_WORLDGEN = 0,
+    RNG_STREAM_COMBAT,
+    RNG_STREAM_AI,
+    RNG_STREAM_PERLIN,  /* permutation shuffle; perlin.c seeds its own Rng with this id */
+    RNG_STREAM_COUNT
+} RngStream;
+
+/* seed a generator; different `stream` values give independent sequences
+ * for the same seed */
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream);
+
+/* next 32 random bits */
+uint32_t rng_next(Rng *r);
+
+/* uniform integer in [0, n); returns 0 when n <= 0 */
+int rng_range(Rng *r, int n);
+
+/* uniform integer in [lo, hi] (inclusive) */
+int rng_between(Rng *r, int lo, int hi);
+
+/* uniform float in [0, 1) */
+float rng_float(Rng *r);
+
+/* (re)seed all global streams from one seed */
+void rng_init_streams(uint64_t seed);
+
+/* global generator for subsystem `s` (not thread-safe; threads should seed
+ * their own Rng) */
+Rng *rng_stream(RngStream s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RNG_H */
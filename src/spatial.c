@@ -0,0 +1,172 @@
+/* spatial.c - where units are: occupancy grid plus bucketed spatial hash */
+#include <stdlib.h>
+
+#include "hex_utils.h"
+#include "spatial.h"
+
+typedef struct {
+    UnitId *ids;
+    int count, cap;
+} Bucket;
+
+static int s_rows = 0, s_cols = 0;
+static UnitId *s_occ = NULL;        /* rows*cols */
+static Bucket *s_buckets = NULL;    /* brows*bcols */
+static int s_brows = 0, s_bcols = 0;
+
+static int on_map(int row, int col) {
+    return s_occ && row >= 0 && row < s_rows && col >= 0 && col < s_cols;
+}
+
+static Bucket *bucket_of(int row, int col) {
+    return &s_buckets[(row / SPATIAL_BUCKET) * s_bcols + col / SPATIAL_BUCKET];
+}
+
+static void index_add(UnitId id, int row, int col) {
+    if (!on_map(row, col)) return;
+    Bucket *b = bucket_of(row, col);
+    if (b->count == b->cap) {
+        int cap = b->cap ? b->cap * 2 : 8;
+        UnitId *p = realloc(b->ids, sizeof(UnitId) * cap);
+        if (!p) return; /* unit stays unindexed; queries just miss it */
+        b->ids = p;
+        b->cap = cap;
+    }
+    b->ids[b->count++] = id;
+    s_occ[row * s_cols + col] = id;
+}
+
+static void index_remove(UnitId id, int row, int col) {
+    if (!on_map(row, col)) return;
+    Bucket *b = bucket_of(row, col);
+    for (int i = 0; i < b->count; ++i) {
+        if (b->ids[i] != id) continue;
+        b->ids[i] = b->ids[--b->count];
+        break;
+    }
+    UnitId *cell = &s_occ[row * s_cols + col];
+    if (*cell != id) return;
+    /* hand the cell to another unit standing on it, if any */
+    *cell = UNIT_NONE;
+    for (int i = 0; i < b->count; ++i) {
+        int k = unit_index(b->ids[i]);
+        if (k >= 0 && g_units.x[k] == row && g_units.y[k] == col) { *cell = b->ids[i]; break; }
+    }
+}
+
+void spatial_free(void) {
+    for (int i = 0; i < s_brows * s_bcols; ++i) free(s_buckets[i].ids);
+    free(s_buckets);
+    free(s_occ);
+    s_buckets = NULL;
+    s_occ = NULL;
+    s_rows = s_cols = s_brows = s_bcols = 0;
+}
+
+int spatial_init(int rows, int cols) {
+    spatial_free();
+    if (rows <= 0 || cols <= 0) return -1;
+    s_brows = (rows + SPATIAL_BUCKET - 1) / SPATIAL_BUCKET;
+    s_bcols = (cols + SPATIAL_BUCKET - 1) / SPATIAL_BUCKET;
+    s_occ = calloc((size_t)rows * cols, sizeof(UnitId));
+    s_buckets = calloc((size_t)s_brows * s_bcols, sizeof(Bucket));
+    if (!s_occ || !s_buckets) { spatial_free(); return -1; }
+    s_rows = rows;
+    s_cols = cols;
+    for (int k = 0; k < g_units.count; ++k) index_add(g_units.id[k], g_units.x[k], g_units.y[k]);
+    return 0;
+}
+
+void spatial_insert(UnitId id) {
+    int k = unit_index(id);
+    if (k >= 0) index_add(id, g_units.x[k], g_units.y[k]);
+}
+
+void spatial_remove(UnitId id) {
+    int k = unit_index(id);
+    if (k >= 0) index_remove(id, g_units.x[k], g_units.y[k]);
+}
+
+void spatial_move(UnitId id, int row, int col) {
+    int k = unit_index(id);
+    if (k < 0) return;
+    if (g_units.x[k] == row && g_units.y[k] == col) return;
+    index_remove(id, g_units.x[k], g_units.y[k]);
+    g_units.x[k] = row;
+    g_units.y[k] = col;
+    index_add(id, row, col);
+}
+
+UnitId spatial_unit_at(int row, int col) {
+    return on_map(row, col) ? s_occ[row * s_cols + col] : UNIT_NONE;
+}
+
+/* bucket range covering every cell within `radius` of (row,col); a hex step
+ * moves at most one row and one column, so the square of half-width radius
+ * contains the hex range */
+static void bucket_span(int row, int col, int radius, int *br0, int *br1, int *bc0, int *bc1) {
+    int r0 = row - radius, r1 = row + radius, c0 = col - radius, c1 = col + radius;
+    if (r0 < 0) r0 = 0;
+    if (c0 < 0) c0 = 0;
+    if (r1 >= s_rows) r1 = s_rows - 1;
+    if (c1 >= s_cols) c1 = s_cols - 1;
+    *br0 = r0 / SPATIAL_BUCKET; *br1 = r1 / SPATIAL_BUCKET;
+    *bc0 = c0 / SPATIAL_BUCKET; *bc1 = c1 / SPATIAL_BUCKET;
+}
+
+int spatial_query(int row, int col, int radius, UnitId *out, int max) {
+    if (!s_occ || radius < 0) return 0;
+    int br0, br1, bc0, bc1, found = 0;
+    bucket_span(row, col, radius, &br0, &br1, &bc0, &bc1);
+    for (int br = br0; br <= br1; ++br) {
+        for (int bc = bc0; bc <= bc1; ++bc) {
+            const Bucket *b = &s_buckets[br * s_bcols + bc];
+            for (int i = 0; i < b->count; ++i) {
+                int k = unit_index(b->ids[i]);
+                if (k < 0 || hex_distance_cells(row, col, g_units.x[k], g_units.y[k]) > radius) continue;
+                if (found < max && out) out[found] = b->ids[i];
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+int spatial_nearest(int row, int col, int max_radius, int (*accept)(int dense, void *user), void *user) {
+    if (!s_occ) return -1;
+    int best = -1, best_d = 0;
+    int cbr = row / SPATIAL_BUCKET, cbc = col / SPATIAL_BUCKET;
+    if (cbr < 0) cbr = 0;
+    if (cbr >= s_brows) cbr = s_brows - 1;
+    if (cbc < 0) cbc = 0;
+    if (cbc >= s_bcols) cbc = s_bcols - 1;
+    int max_ring = s_brows > s_bcols ? s_brows : s_bcols;
+    /* visit square rings of buckets outward; cells in ring k are at least
+     * (k-1)*SPATIAL_BUCKET+1 away, which bounds when to stop */
+    for (int ring = 0; ring <= max_ring; ++ring) {
+        int min_d = ring == 0 ? 0 : (ring - 1) * SPATIAL_BUCKET + 1;
+        if (best >= 0 && min_d > best_d) break;
+        if (max_radius >= 0 && min_d > max_radius) break;
+        for (int br = cbr - ring; br <= cbr + ring; ++br) {
+            if (br < 0 || br >= s_brows) continue;
+            int edge = br == cbr - ring || br == cbr + ring;
+            for (int bc = cbc - ring; bc <= cbc + ring; bc += edge ? 1 : 2 * ring) {
+                if (bc >= 0 && bc < s_bcols) {
+                    const Bucket *b = &s_buckets[br * s_bcols + bc];
+                    for (int i = 0; i < b->count; ++i) {
+                        int k = unit_index(b->ids[i]);
+                        if (k < 0) continue;
+                        int d = hex_distance_cells(row, col, g_units.x[k], g_units.y[k]);
+                        if (max_radius >= 0 && d > max_radius) continue;
+                        if (best >= 0 && (d > best_d || (d == best_d && k > best))) continue;
+                        if (accept && !accept(k, user)) continue;
+                        best = k;
+                        best_d = d;
+                    }
+                }
+                if (ring == 0) break;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,43 @@
+/* spatial.h - where units are: occupancy grid plus bucketed spatial hash */
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include "units.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* cells per bucket edge; radius queries visit only the overlapping buckets */
+#define SPATIAL_BUCKET 16
+
+/* Size the index for a rows x cols map and add every existing unit. While
+ * the index is live, unit positions must change through spatial_move (the
+ * sprite_* setters do). Returns 0 on success, -1 if out of memory. */
+int spatial_init(int rows, int cols);
+void spatial_free(void);
+
+/* keep the index in step with the unit store; no-ops while not initialized */
+void spatial_insert(UnitId id);
+void spatial_remove(UnitId id);
+/* set g_units.x/y of `id` and update the index */
+void spatial_move(UnitId id, int row, int col);
+
+/* Unit on (row,col), UNIT_NONE if empty. With several on one cell, the
+ * latest to arrive. O(1). */
+UnitId spatial_unit_at(int row, int col);
+
+/* Units within hex distance `radius` of (row,col). Writes up to `max` ids
+ * to `out` and returns how many matched (possibly more than `max`). */
+int spatial_query(int row, int col, int radius, UnitId *out, int max);
+
+/* Dense index of the closest unit to (row,col) for which accept(dense, user)
+ * is non-zero, searching at most `max_radius` away (< 0 = whole map).
+ * Ties go to the lowest dense index. Returns -1 if none. */
+int spatial_nearest(int row, int col, int max_radius, int (*accept)(int dense, void *user), void *user);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPATIAL_H */
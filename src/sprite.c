@@ -2,35 +2,37 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "atlas.h"
+#include "combat.h"
+#include "intern.h"
 #include "job.h"
+#include "pool.h"
+#include "spatial.h"
 #include "sprite.h"
 
-static char *safe_strdup(const char *s) {
-    if (!s) return NULL;
-    size_t n = strlen(s) + 1;
-    char *p = malloc(n);
-    if (!p) return NULL;
-    memcpy(p, s, n);
-    return p;
-}
+static Pool s_sprite_pool = POOL_INIT(Sprite, 256);
 
 Sprite *sprite_create(const char *name, const char *job, const char *image, int level) {
-    Sprite *s = (Sprite *)malloc(sizeof(Sprite));
+    Sprite *s = (Sprite *)pool_alloc(&s_sprite_pool);
     if (!s) return NULL;
-    s->name = safe_strdup(name ? name : "");
-    s->job = safe_strdup(job ? job : "");
-    s->image = safe_strdup(image ? image : "");
-    s->level = level > 0 ? level : 1;
+    s->unit = unit_create(s);
+    if (s->unit == UNIT_NONE) { pool_free(&s_sprite_pool, s); return NULL; }
+    s->name = str_intern(name ? name : "");
+    s->job = str_intern(job ? job : "");
+    s->image = str_intern(image ? image : "");
+    int u = unit_index(s->unit);
+    g_units.level[u] = level > 0 ? level : 1;
+    g_units.job[u] = get_job_type(s->job);
     /* simple default stats based on level */
-    s->max_hp = 100 + (s->level - 1) * 10;
-    s->hp = s->max_hp;
-    s->max_mp = 30 + (s->level - 1) * 5;
-    s->mp = s->max_mp;
-    s->move = 2;
+    g_units.max_hp[u] = 100 + (g_units.level[u] - 1) * 10;
+    g_units.hp[u] = g_units.max_hp[u];
+    g_units.max_mp[u] = 30 + (g_units.level[u] - 1) * 5;
+    g_units.mp[u] = g_units.max_mp[u];
+    g_units.move[u] = 2;
     s->jump = 1;
-    s->speed = 5;
-    s->attack = 10 + (s->level - 1) * 2;
-    s->defense = 5 + (s->level - 1) * 1;
+    g_units.speed[u] = 5;
+    g_units.attack[u] = 10 + (g_units.level[u] - 1) * 2;
+    g_units.defense[u] = 5 + (g_units.level[u] - 1) * 1;
     for (int i = 0; i < MAX_EQUIP_SLOTS; ++i) {
         s->equipments[i].name = NULL;
         s->equipments[i].type = 0;
@@ -43,190 +45,104 @@ Sprite *sprite_create(const char *name, const char *job, const char *image, int
         s->equipments[i].mov = 0;
         s->equipments[i].spec = 0;
     }
-    s->x = 0;
-    s->y = 0;
+    g_units.x[u] = 0;
+    g_units.y[u] = 0;
+    spatial_insert(s->unit);
+    s->anim_idle = ATLAS_NONE;
+    s->anim_run = ATLAS_NONE;
     return s;
 }
 
 void sprite_destroy(Sprite *s) {
     if (!s) return;
-    free(s->name);
-    free(s->job);
-    free(s->image);
-    for (int i = 0; i < 3; ++i) {
-        if (s->equipments[i].name) {
-            free(s->equipments[i].name);
-        }
-    }
-    free(s);
+    spatial_remove(s->unit);
+    unit_destroy(s->unit);
+    /* strings are interned and owned by the intern table */
+    pool_free(&s_sprite_pool, s);
+}
+
+void sprite_pool_clear(void) {
+    pool_destroy(&s_sprite_pool);
 }
 
 const char *sprite_get_name(const Sprite *s) { return s ? s->name : NULL; }
 const char *sprite_get_job(const Sprite *s) { return s ? s->job : NULL; }
 const char *sprite_get_image(const Sprite *s) { return s ? s->image : NULL; }
-int sprite_get_level(const Sprite *s) { return s ? s->level : 0; }
-int sprite_get_hp(const Sprite *s) { return s ? s->hp : 0; }
-int sprite_get_mp(const Sprite *s) { return s ? s->mp : 0; }
-int sprite_get_x(const Sprite *s) { return s ? s->x : 0; }
-int sprite_get_y(const Sprite *s) { return s ? s->y : 0; }
+int sprite_get_level(const Sprite *s) { return s ? SPRITE_FIELD(s, level) : 0; }
+int sprite_get_hp(const Sprite *s) { return s ? SPRITE_FIELD(s, hp) : 0; }
+int sprite_get_mp(const Sprite *s) { return s ? SPRITE_FIELD(s, mp) : 0; }
+int sprite_get_x(const Sprite *s) { return s ? SPRITE_FIELD(s, x) : 0; }
+int sprite_get_y(const Sprite *s) { return s ? SPRITE_FIELD(s, y) : 0; }
 
 void sprite_set_name(Sprite *s, const char *name) {
     if (!s) return;
-    char *n = safe_strdup(name ? name : "");
+    const char *n = str_intern(name ? name : "");
     if (!n) return;
-    free(s->name);
     s->name = n;
 }
 
 void sprite_set_job(Sprite *s, const char *job) {
     if (!s) return;
-    char *n = safe_strdup(job ? job : "");
+    const char *n = str_intern(job ? job : "");
     if (!n) return;
-    free(s->job);
     s->job = n;
+    SPRITE_FIELD(s, job) = get_job_type(n);
 }
 
 void sprite_set_image(Sprite *s, const char *image) {
     if (!s) return;
-    char *n = safe_strdup(image ? image : "");
+    const char *n = str_intern(image ? image : "");
     if (!n) return;
-    free(s->image);
     s->image = n;
 }
 
 void sprite_set_position(Sprite *s, int x, int y) {
     if (!s) return;
-    s->x = x;
-    s->y = y;
+    spatial_move(s->unit, x, y);
 }
 
 void sprite_set_hp(Sprite *s, int hp) {
     if (!s) return;
     if (hp < 0) hp = 0;
-    if (hp > s->max_hp) hp = s->max_hp;
-    s->hp = hp;
+    if (hp > SPRITE_FIELD(s, max_hp)) hp = SPRITE_FIELD(s, max_hp);
+    SPRITE_FIELD(s, hp) = hp;
 }
 
 void sprite_set_mp(Sprite *s, int mp) {
     if (!s) return;
     if (mp < 0) mp = 0;
-    if (mp > s->max_mp) mp = s->max_mp;
-    s->mp = mp;
+    if (mp > SPRITE_FIELD(s, max_mp)) mp = SPRITE_FIELD(s, max_mp);
+    SPRITE_FIELD(s, mp) = mp;
 }
 
 int sprite_move(Sprite *s, int dx, int dy) {
     if (!s) return -1;
-    s->x += dx;
-    s->y += dy;
+    spatial_move(s->unit, SPRITE_FIELD(s, x) + dx, SPRITE_FIELD(s, y) + dy);
     return 0;
 }
 
-// 计算物理攻击伤害
-int calculate_physical_damage(Sprite *attacker, Sprite *defender) {
-    if (!attacker || !defender) return 0;
-
-    int base_damage = attacker->attack;
-    int defense = defender->defense;
-
-    // 基础伤害计算：攻击力 - 防御力
-    int damage = base_damage - defense;
-
-    // 职业加成
-    JobType job_type = get_job_type(attacker->job);
-    switch (job_type) {
-        case JOB_WARRIOR:
-            damage += base_damage * 0.2; // 战士额外20%伤害
-            break;
-        case JOB_ROGUE:
-            // 盗贼有暴击几率
-            if (rand() % 100 < 30) { // 30%暴击几率
-                damage *= 2;
-            }
-            break;
-        case JOB_ARCHER:
-            damage += 5; // 弓箭手固定加成
-            break;
-        default:
-            break;
-    }
-
-    // 等级加成
-    damage += attacker->level * 2;
-
-    // 随机波动 (±10%)
-    int variation = damage * 0.1;
-    damage += (rand() % (2 * variation + 1)) - variation;
-
-    // 确保最小伤害为1
-    if (damage < 1) damage = 1;
-
-    return damage;
-}
-
-// 计算魔法攻击伤害
-int calculate_magic_damage(Sprite *attacker, Sprite *defender) {
-    if (!attacker || !defender) return 0;
-
-    int base_damage = attacker->attack;
-
-    // 魔法伤害基于攻击力和魔法值
-    int damage = base_damage + attacker->mp * 0.5;
-
-    // 职业加成
-    JobType job_type = get_job_type(attacker->job);
-    switch (job_type) {
-        case JOB_MAGE:
-            damage += base_damage * 0.3; // 法师额外30%魔法伤害
-            break;
-        case JOB_CLERIC:
-            // 牧师对不死系有额外伤害（这里简化处理）
-            if (defender->hp < defender->max_hp * 0.3) {
-                damage += 10; // 对低血量目标额外伤害
-            }
-            break;
-        default:
-            break;
-    }
-
-    // 等级加成
-    damage += attacker->level * 3;
-
-    // 随机波动 (±15%)
-    int variation = damage * 0.15;
-    damage += (rand() % (2 * variation + 1)) - variation;
-
-    // 确保最小伤害为1
-    if (damage < 1) damage = 1;
-
-    // 消耗魔法值
-    int mp_cost = damage / 5 + 5;
-    if (mp_cost > attacker->mp) {
-        mp_cost = attacker->mp; // 最多消耗所有魔法值
-    }
-    attacker->mp -= mp_cost;
-
-    return damage;
+int sprite_attack(Sprite *attacker, Sprite *defender, int attack_mode) {
+    return sprite_attack_rng(attacker, defender, attack_mode, rng_stream(RNG_STREAM_COMBAT));
 }
 
-int sprite_attack(Sprite *attacker, Sprite *defender, int attack_mode) {
+int sprite_attack_rng(Sprite *attacker, Sprite *defender, int attack_mode, Rng *rng) {
     if (!attacker || !defender) return 0;
-
-    int damage = 0;
-
-    // 根据攻击模式选择伤害计算方式
-    if (attack_mode == ATTACK_MODE_PHYSICAL) {
-        damage = calculate_physical_damage(attacker, defender);
-    } else if (attack_mode == ATTACK_MODE_MAGIC) {
-        damage = calculate_magic_damage(attacker, defender);
-    } else {
-        // 默认使用物理攻击
-        damage = calculate_physical_damage(attacker, defender);
-    }
+    if (!rng) rng = rng_stream(RNG_STREAM_COMBAT);
+
+    // 职业与攻击模式对应的规则（combat.h）
+    const CombatRule *rule = combat_rule((JobType)SPRITE_FIELD(attacker, job), attack_mode);
+    CombatStats st = {
+        SPRITE_FIELD(attacker, attack), SPRITE_FIELD(attacker, level), SPRITE_FIELD(attacker, mp),
+        SPRITE_FIELD(defender, defense), SPRITE_FIELD(defender, hp), SPRITE_FIELD(defender, max_hp)
+    };
+    int mp_cost = 0;
+    int damage = combat_eval(rule, &st, rng, &mp_cost);
+    SPRITE_FIELD(attacker, mp) -= mp_cost;
 
     // 应用伤害
-    if (damage > defender->hp) damage = defender->hp;
-    defender->hp -= damage;
-    if (defender->hp < 0) defender->hp = 0;
+    if (damage > SPRITE_FIELD(defender, hp)) damage = SPRITE_FIELD(defender, hp);
+    SPRITE_FIELD(defender, hp) -= damage;
+    if (SPRITE_FIELD(defender, hp) < 0) SPRITE_FIELD(defender, hp) = 0;
 
     return damage;
 }
@@ -239,15 +155,22 @@ int sprite_use_item(Sprite *s, const char *item_id) {
     */
     if (strcmp(item_id, "potion") == 0) {
         int heal = 50;
-        s->hp += heal;
-        if (s->hp > s->max_hp) s->hp = s->max_hp;
+        SPRITE_FIELD(s, hp) += heal;
+        if (SPRITE_FIELD(s, hp) > SPRITE_FIELD(s, max_hp)) SPRITE_FIELD(s, hp) = SPRITE_FIELD(s, max_hp);
         return 1;
     }
     if (strcmp(item_id, "ether") == 0) {
         int restore = 30;
-        s->mp += restore;
-        if (s->mp > s->max_mp) s->mp = s->max_mp;
+        SPRITE_FIELD(s, mp) += restore;
+        if (SPRITE_FIELD(s, mp) > SPRITE_FIELD(s, max_mp)) SPRITE_FIELD(s, mp) = SPRITE_FIELD(s, max_mp);
         return 1;
     }
     return 0; /* unknown item */
-}
\ No newline at end of file
+}
+
+int sprite_bind_anims(Sprite *s) {
+    if (!s) return 0;
+    s->anim_idle = atlas_find_anim(s->image, "idle");
+    s->anim_run = atlas_find_anim(s->image, "run");
+    return s->anim_idle != ATLAS_NONE;
+}
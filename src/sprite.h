@@ -3,6 +3,10 @@
 
 #include <stdint.h>
 
+#include "job.h"
+#include "rng.h"
+#include "units.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -18,7 +22,7 @@ typedef enum {
 } EquipType;
 
 typedef struct Equipment {
-    char *name;
+    const char *name; /* interned (intern.h), NULL for an empty slot */
     int type;
     int hp;
     int mp;
@@ -30,28 +34,33 @@ typedef struct Equipment {
     int spec; /* bitfield for special properties (e.g. elemental affinity) */
 } Equipment;
 
+/* A Sprite holds a unit's cold data. Its hot fields (position, hp, mp,
+ * attack, defense, speed, move, level, faction, and the JobType resolved
+ * from `job` on create and sprite_set_job) live in the unit manager's
+ * arrays (units.h) and are reached through SPRITE_FIELD or the getters below.
+ * Sprites come from a pool and their strings are interned, so creating and
+ * destroying them does no per-sprite malloc/free once the pool is warm.
+ */
 typedef struct Sprite {
-    char *name;
-    char *job;
-    char *image;
-    int level;
-    int max_hp;
-    int hp;
-    int max_mp;
-    int mp;
-    int move;
+    UnitId unit;
+    const char *name;   /* interned */
+    const char *job;    /* interned */
+    const char *image;  /* interned */
     int jump;
-    int speed;
-    int attack;
-    int defense;
     Equipment equipments[MAX_EQUIP_SLOTS];
-    int x;
-    int y;
+    /* atlas animations (AtlasFrameId, see atlas.h); -1 when not bound */
+    int anim_idle;
+    int anim_run;
 } Sprite;
 
+/* hot field `f` of sprite `s` in the unit manager; usable as an lvalue */
+#define SPRITE_FIELD(s, f) (g_units.f[unit_index((s)->unit)])
+
 /* Creation / destruction */
 Sprite *sprite_create(const char *name, const char *job, const char *image, int level);
 void sprite_destroy(Sprite *s);
+/* Release the sprite pool's memory; every sprite must be destroyed first */
+void sprite_pool_clear(void);
 
 /* Basic getters */
 const char *sprite_get_name(const Sprite *s);
@@ -74,8 +83,15 @@ void sprite_set_mp(Sprite *s, int mp);
 /* Actions */
 int sprite_move(Sprite *s, int dx, int dy);
 int sprite_attack(Sprite *attacker, Sprite *defender, int attack_mode);
+/* same as sprite_attack but draws random rolls from `rng` instead of the
+ * global combat stream (use one Rng per thread) */
+int sprite_attack_rng(Sprite *attacker, Sprite *defender, int attack_mode, Rng *rng);
 int sprite_use_item(Sprite *s, const char *item_id);
 
+/* Resolve "<image>_idle_anim" / "<image>_run_anim" in the loaded atlas once,
+ * so drawing uses the ids instead of names. Returns 1 if an idle anim exists. */
+int sprite_bind_anims(Sprite *s);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,89 @@
+/* spritebatch.c - textured quads from one atlas submitted in a single draw */
+#include <stdlib.h>
+
+#include "spritebatch.h"
+
+static int batch_grow(SpriteBatch *b) {
+    int cap = b->cap ? b->cap * 2 : 256;
+    SDL_Rect *src = realloc(b->src, sizeof(SDL_Rect) * cap);
+    if (!src) return -1;
+    b->src = src;
+    SDL_Rect *dst = realloc(b->dst, sizeof(SDL_Rect) * cap);
+    if (!dst) return -1;
+    b->dst = dst;
+#if SPRITE_BATCH_GEOMETRY
+    SDL_Vertex *verts = realloc(b->verts, sizeof(SDL_Vertex) * 4 * cap);
+    if (!verts) return -1;
+    b->verts = verts;
+    int *indices = realloc(b->indices, sizeof(int) * 6 * cap);
+    if (!indices) return -1;
+    b->indices = indices;
+    /* two triangles per quad; the pattern never changes */
+    for (int q = b->cap; q < cap; ++q) {
+        int v = q * 4, *ix = indices + q * 6;
+        ix[0] = v; ix[1] = v + 1; ix[2] = v + 2;
+        ix[3] = v; ix[4] = v + 2; ix[5] = v + 3;
+    }
+#endif
+    b->cap = cap;
+    return 0;
+}
+
+void sprite_batch_begin(SpriteBatch *b, SDL_Texture *tex, const SDL_Rect *view) {
+    int w = 1, h = 1;
+    b->tex = tex;
+    if (tex) SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+    b->inv_w = 1.0f / (float)(w > 0 ? w : 1);
+    b->inv_h = 1.0f / (float)(h > 0 ? h : 1);
+    b->view = *view;
+    b->count = 0;
+    b->culled = 0;
+}
+
+int sprite_batch_add(SpriteBatch *b, const SDL_Rect *src, const SDL_Rect *dst) {
+    if (!SDL_HasIntersection(dst, &b->view)) { b->culled++; return 0; }
+    if (b->count == b->cap && batch_grow(b) != 0) return 0;
+    int q = b->count++;
+    b->src[q] = *src;
+    b->dst[q] = *dst;
+#if SPRITE_BATCH_GEOMETRY
+    float x0 = (float)dst->x, y0 = (float)dst->y;
+    float x1 = x0 + dst->w, y1 = y0 + dst->h;
+    float u0 = src->x * b->inv_w, v0 = src->y * b->inv_h;
+    float u1 = (src->x + src->w) * b->inv_w, v1 = (src->y + src->h) * b->inv_h;
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Vertex *v = b->verts + q * 4;
+    v[0].position.x = x0; v[0].position.y = y0; v[0].tex_coord.x = u0; v[0].tex_coord.y = v0; v[0].color = white;
+    v[1].position.x = x1; v[1].position.y = y0; v[1].tex_coord.x = u1; v[1].tex_coord.y = v0; v[1].color = white;
+    v[2].position.x = x1; v[2].position.y = y1; v[2].tex_coord.x = u1; v[2].tex_coord.y = v1; v[2].color = white;
+    v[3].position.x = x0; v[3].position.y = y1; v[3].tex_coord.x = u0; v[3].tex_coord.y = v1; v[3].color = white;
+#endif
+    return 1;
+}
+
+int sprite_batch_flush(SpriteBatch *b, SDL_Renderer *renderer) {
+    int n = b->count;
+    if (n == 0 || !b->tex) { b->count = 0; return 0; }
+#if SPRITE_BATCH_GEOMETRY
+    if (SDL_RenderGeometry(renderer, b->tex, b->verts, n * 4, b->indices, n * 6) == 0) {
+        b->count = 0;
+        return n;
+    }
+    /* the backend has no geometry support */
+#endif
+    for (int q = 0; q < n; ++q) SDL_RenderCopy(renderer, b->tex, &b->src[q], &b->dst[q]);
+    b->count = 0;
+    return n;
+}
+
+void sprite_batch_free(SpriteBatch *b) {
+#if SPRITE_BATCH_GEOMETRY
+    free(b->verts);
+    free(b->indices);
+    b->verts = NULL; b->indices = NULL;
+#endif
+    free(b->src);
+    free(b->dst);
+    b->src = NULL; b->dst = NULL;
+    b->count = b->cap = 0;
+}
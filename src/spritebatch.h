@@ -0,0 +1,54 @@
+/* spritebatch.h - textured quads from one atlas submitted in a single draw */
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <SDL2/SDL.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* SDL_RenderGeometry and SDL_Vertex appeared in SDL 2.0.18; older SDL
+ * draws the batch with one SDL_RenderCopy per quad */
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define SPRITE_BATCH_GEOMETRY 1
+#else
+#define SPRITE_BATCH_GEOMETRY 0
+#endif
+
+typedef struct {
+    SDL_Texture *tex;
+    float inv_w, inv_h;   /* texel -> [0,1] texture coordinates */
+    SDL_Rect view;        /* quads outside this rect are culled */
+#if SPRITE_BATCH_GEOMETRY
+    SDL_Vertex *verts;    /* 4 per quad */
+    int *indices;         /* 6 per quad, rebuilt only when capacity grows */
+#endif
+    SDL_Rect *src, *dst;  /* kept for the SDL_RenderCopy path */
+    int count, cap;
+    int culled;           /* quads dropped since begin */
+} SpriteBatch;
+
+/* Start collecting quads sampling `tex`; anything not intersecting `view`
+ * (in render coordinates) is skipped. The batch keeps its buffers between
+ * frames, so a zero-initialized SpriteBatch can be reused indefinitely.
+ */
+void sprite_batch_begin(SpriteBatch *b, SDL_Texture *tex, const SDL_Rect *view);
+
+/* queue the `src` region of the texture drawn at `dst`; returns 0 if culled */
+int sprite_batch_add(SpriteBatch *b, const SDL_Rect *src, const SDL_Rect *dst);
+
+/* Draw everything queued with one SDL_RenderGeometry call (one RenderCopy
+ * per quad on SDL < 2.0.18 or when the backend rejects geometry) and empty
+ * the batch.
+ * Returns the number of quads drawn.
+ */
+int sprite_batch_flush(SpriteBatch *b, SDL_Renderer *renderer);
+
+void sprite_batch_free(SpriteBatch *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPRITEBATCH_H */
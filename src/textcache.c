@@ -0,0 +1,135 @@
+/* textcache.c - LRU cache of rendered single-line text textures */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "textcache.h"
+
+#define TEXTCACHE_BUCKETS (TEXTCACHE_CAPACITY * 2)
+
+typedef struct {
+    uint32_t hash;
+    char* text;
+    TTF_Font* font;
+    SDL_Color color;
+    SDL_Texture* tex;
+    int w, h;
+    int bucket_next;    /* chain within the hash bucket */
+    int prev, next;     /* LRU list, most recent first */
+} TextEntry;
+
+static TextEntry s_entries[TEXTCACHE_CAPACITY];
+static int s_buckets[TEXTCACHE_BUCKETS];
+static int s_used = 0;              /* entries handed out so far */
+static int s_head = -1, s_tail = -1;
+static int s_ready = 0;
+static long s_hits = 0, s_misses = 0;
+
+static void cache_init(void) {
+    for (int i = 0; i < TEXTCACHE_BUCKETS; ++i) s_buckets[i] = -1;
+    s_used = 0;
+    s_head = s_tail = -1;
+    s_ready = 1;
+}
+
+/* FNV-1a over the text, the color and the font handle */
+static uint32_t text_hash(TTF_Font* font, const char* text, SDL_Color color) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)text; *p; ++p) { h ^= *p; h *= 16777619u; }
+    uint32_t extra[2] = { ((uint32_t)color.r << 24) | ((uint32_t)color.g << 16) | ((uint32_t)color.b << 8) | color.a,
+                          (uint32_t)(uintptr_t)font };
+    for (int i = 0; i < 2; ++i) { h ^= extra[i]; h *= 16777619u; }
+    return h;
+}
+
+static void lru_unlink(int i) {
+    TextEntry* e = &s_entries[i];
+    if (e->prev >= 0) s_entries[e->prev].next = e->next; else s_head = e->next;
+    if (e->next >= 0) s_entries[e->next].prev = e->prev; else s_tail = e->prev;
+    e->prev = e->next = -1;
+}
+
+static void lru_push_front(int i) {
+    TextEntry* e = &s_entries[i];
+    e->prev = -1;
+    e->next = s_head;
+    if (s_head >= 0) s_entries[s_head].prev = i;
+    s_head = i;
+    if (s_tail < 0) s_tail = i;
+}
+
+static void bucket_remove(int i) {
+    int* link = &s_buckets[s_entries[i].hash % TEXTCACHE_BUCKETS];
+    while (*link >= 0 && *link != i) link = &s_entries[*link].bucket_next;
+    if (*link == i) *link = s_entries[i].bucket_next;
+}
+
+static void entry_release(TextEntry* e) {
+    if (e->tex) SDL_DestroyTexture(e->tex);
+    free(e->text);
+    e->tex = NULL;
+    e->text = NULL;
+}
+
+SDL_Texture* textcache_get(SDL_Renderer* renderer, TTF_Font* font, const char* text,
+                           SDL_Color color, int* out_w, int* out_h) {
+    if (out_w) *out_w = 0;
+    if (out_h) *out_h = 0;
+    if (!renderer || !font || !text || !text[0]) return NULL;
+    if (!s_ready) cache_init();
+
+    uint32_t hash = text_hash(font, text, color);
+    int bucket = hash % TEXTCACHE_BUCKETS;
+    for (int i = s_buckets[bucket]; i >= 0; i = s_entries[i].bucket_next) {
+        TextEntry* e = &s_entries[i];
+        if (e->hash != hash || e->font != font || memcmp(&e->color, &color, sizeof(color)) != 0 ||
+            strcmp(e->text, text) != 0) continue;
+        if (i != s_head) { lru_unlink(i); lru_push_front(i); }
+        s_hits++;
+        if (out_w) *out_w = e->w;
+        if (out_h) *out_h = e->h;
+        return e->tex;
+    }
+
+    s_misses++;
+    SDL_Surface* surf = TTF_RenderUTF8_Blended(font, text, color);
+    if (!surf) return NULL;
+    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
+    int w = surf->w, h = surf->h;
+    SDL_FreeSurface(surf);
+    if (!tex) return NULL;
+    char* copy = malloc(strlen(text) + 1);
+    if (!copy) { SDL_DestroyTexture(tex); return NULL; }
+    strcpy(copy, text);
+
+    /* take a fresh slot, or recycle the least recently used one */
+    int slot;
+    if (s_used < TEXTCACHE_CAPACITY) {
+        slot = s_used++;
+    } else {
+        slot = s_tail;
+        lru_unlink(slot);
+        bucket_remove(slot);
+        entry_release(&s_entries[slot]);
+    }
+    TextEntry* e = &s_entries[slot];
+    e->hash = hash; e->text = copy; e->font = font; e->color = color;
+    e->tex = tex; e->w = w; e->h = h;
+    e->bucket_next = s_buckets[bucket];
+    s_buckets[bucket] = slot;
+    lru_push_front(slot);
+
+    if (out_w) *out_w = w;
+    if (out_h) *out_h = h;
+    return tex;
+}
+
+void textcache_stats(long* hits, long* misses) {
+    if (hits) *hits = s_hits;
+    if (misses) *misses = s_misses;
+}
+
+void textcache_clear(void) {
+    for (int i = 0; i < s_used; ++i) entry_release(&s_entries[i]);
+    cache_init();
+}
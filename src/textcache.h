@@ -0,0 +1,33 @@
+/* textcache.h - LRU cache of rendered single-line text textures */
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* most textures kept alive; the least recently used one is destroyed first */
+#define TEXTCACHE_CAPACITY 1024
+
+/* Texture for one line of `text` in `font` and `color`, rendered only on the
+ * first request and looked up by content afterwards. The cache owns the
+ * texture: use it right away and never destroy it. Returns NULL for empty
+ * text or on failure; out_w/out_h receive the texture size (0 for NULL).
+ */
+SDL_Texture* textcache_get(SDL_Renderer* renderer, TTF_Font* font, const char* text,
+                           SDL_Color color, int* out_w, int* out_h);
+
+/* lookups served from the cache and lookups that had to render */
+void textcache_stats(long* hits, long* misses);
+
+/* Destroy all cached textures (before closing fonts or the renderer) */
+void textcache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEXTCACHE_H */
@@ -0,0 +1,135 @@
+/* textwrap.c - UTF-8 word wrapping with cached glyph advances */
+#include "textwrap.h"
+
+void glyph_cache_init(GlyphCache *gc, GlyphAdvanceFn advance, void *user) {
+    gc->advance = advance;
+    gc->user = user;
+    for (int i = 0; i < 128; ++i) gc->ascii[i] = -1;
+    for (int i = 0; i < GLYPH_CACHE_SIZE; ++i) gc->keys[i] = 0;
+    gc->count = 0;
+}
+
+int glyph_cache_advance(GlyphCache *gc, uint32_t cp) {
+    if (cp < 128) {
+        if (gc->ascii[cp] < 0) gc->ascii[cp] = gc->advance(gc->user, cp);
+        return gc->ascii[cp];
+    }
+    uint32_t slot = (cp * 2654435761u) & (GLYPH_CACHE_SIZE - 1);
+    for (int probe = 0; probe < GLYPH_CACHE_SIZE; ++probe) {
+        if (gc->keys[slot] == cp) return gc->values[slot];
+        if (gc->keys[slot] == 0) break;
+        slot = (slot + 1) & (GLYPH_CACHE_SIZE - 1);
+    }
+    int adv = gc->advance(gc->user, cp);
+    /* keep the table at most 3/4 full; beyond that glyphs are just measured */
+    if (gc->keys[slot] == 0 && gc->count < GLYPH_CACHE_SIZE * 3 / 4) {
+        gc->keys[slot] = cp;
+        gc->values[slot] = adv;
+        gc->count++;
+    }
+    return adv;
+}
+
+uint32_t utf8_decode(const char *s, int *len) {
+    const unsigned char *u = (const unsigned char *)s;
+    uint32_t cp;
+    int n;
+    if (u[0] < 0x80) { *len = 1; return u[0]; }
+    else if ((u[0] & 0xE0) == 0xC0) { cp = u[0] & 0x1F; n = 2; }
+    else if ((u[0] & 0xF0) == 0xE0) { cp = u[0] & 0x0F; n = 3; }
+    else if ((u[0] & 0xF8) == 0xF0) { cp = u[0] & 0x07; n = 4; }
+    else { *len = 1; return 0xFFFD; }
+    for (int i = 1; i < n; ++i) {
+        if ((u[i] & 0xC0) != 0x80) { *len = 1; return 0xFFFD; }
+        cp = (cp << 6) | (u[i] & 0x3F);
+    }
+    *len = n;
+    return cp;
+}
+
+/* ideographs, kana, hangul and fullwidth forms: a line may break on either side */
+static int is_cjk(uint32_t cp) {
+    return (cp >= 0x2E80 && cp <= 0x9FFF) ||   /* radicals, punctuation, kana, CJK ideographs */
+           (cp >= 0xAC00 && cp <= 0xD7AF) ||   /* hangul syllables */
+           (cp >= 0xF900 && cp <= 0xFAFF) ||   /* compatibility ideographs */
+           (cp >= 0xFF00 && cp <= 0xFFEF) ||   /* fullwidth forms */
+           (cp >= 0x20000 && cp <= 0x3FFFF);   /* supplementary ideographs */
+}
+
+/* punctuation that must not start a line */
+static int no_break_before(uint32_t cp) {
+    switch (cp) {
+        case 0x3001: case 0x3002: case 0xFF0C: case 0xFF0E: case 0xFF01: case 0xFF1F:
+        case 0xFF1A: case 0xFF1B: case 0xFF09: case 0x300D: case 0x300F: case 0x3011:
+        case 0x300B: case 0x3009: case 0x30FC:
+        case ',': case '.': case '!': case '?': case ':': case ';': case ')':
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void emit(TextSpan *spans, int max_spans, int *count, int start, int end, int width) {
+    if (*count < max_spans) {
+        spans[*count].start = start;
+        spans[*count].len = end - start;
+        spans[*count].width = width;
+    }
+    (*count)++;
+}
+
+int textwrap(GlyphCache *gc, const char *text, int max_width, TextSpan *spans, int max_spans) {
+    if (!text) return 0;
+    int count = 0;
+    int line_start = 0, line_w = 0;
+    /* best break so far: the line ends at brk_end (width brk_w) and the next one
+     * starts at brk_next, which lies brk_next_w pixels into the current line */
+    int brk_end = -1, brk_w = 0, brk_next = 0, brk_next_w = 0;
+    int prev_cjk = 0;
+    int i = 0;
+    while (text[i]) {
+        int n;
+        uint32_t cp = utf8_decode(text + i, &n);
+        if (cp == '\n') {
+            emit(spans, max_spans, &count, line_start, i, line_w);
+            i += n;
+            line_start = i; line_w = 0;
+            brk_end = -1; prev_cjk = 0;
+            continue;
+        }
+        if (cp == ' ' || cp == '\t') {
+            /* break here: the line keeps everything before the space run and the
+             * next one starts after it, so wrapped lines never begin with spaces */
+            if (brk_end < 0 || brk_next < i) { brk_end = i; brk_w = line_w; }
+            int adv = glyph_cache_advance(gc, ' ');
+            line_w += adv;
+            i += n;
+            brk_next = i; brk_next_w = line_w;
+            prev_cjk = 0;
+            continue;
+        }
+        int cjk = is_cjk(cp);
+        if ((cjk || prev_cjk) && i > line_start && !no_break_before(cp)) {
+            brk_end = i; brk_w = line_w; brk_next = i; brk_next_w = line_w;
+        }
+        int adv = glyph_cache_advance(gc, cp);
+        if (line_w + adv > max_width && i > line_start) {
+            if (brk_end > line_start) {
+                emit(spans, max_spans, &count, line_start, brk_end, brk_w);
+                line_start = brk_next;
+                line_w -= brk_next_w;
+            } else {
+                /* no break opportunity: split the word here */
+                emit(spans, max_spans, &count, line_start, i, line_w);
+                line_start = i;
+                line_w = 0;
+            }
+            brk_end = -1;
+        }
+        line_w += adv;
+        prev_cjk = cjk;
+        i += n;
+    }
+    if (i > line_start || count == 0) emit(spans, max_spans, &count, line_start, i, line_w);
+    return count;
+}
@@ -0,0 +1,54 @@
+/* textwrap.h - UTF-8 word wrapping with cached glyph advances */
+#ifndef TEXTWRAP_H
+#define TEXTWRAP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* advance width in pixels of one code point; supplied by the font backend */
+typedef int (*GlyphAdvanceFn)(void *user, uint32_t codepoint);
+
+#define GLYPH_CACHE_SIZE 1024 /* non-ASCII code points remembered (power of two) */
+
+typedef struct {
+    GlyphAdvanceFn advance;
+    void *user;
+    int ascii[128];                       /* -1 until measured */
+    uint32_t keys[GLYPH_CACHE_SIZE];      /* open addressing, 0 = empty */
+    int values[GLYPH_CACHE_SIZE];
+    int count;
+} GlyphCache;
+
+/* one wrapped line: bytes [start, start+len) of the source text */
+typedef struct {
+    int start;
+    int len;
+    int width; /* pixels, trailing break spaces excluded */
+} TextSpan;
+
+void glyph_cache_init(GlyphCache *gc, GlyphAdvanceFn advance, void *user);
+
+/* advance of `cp`, measured through the callback only the first time */
+int glyph_cache_advance(GlyphCache *gc, uint32_t cp);
+
+/* Decode one UTF-8 code point at s; stores its byte length in *len (>= 1).
+ * Invalid bytes decode as U+FFFD one byte at a time.
+ */
+uint32_t utf8_decode(const char *s, int *len);
+
+/* Wrap `text` to `max_width` pixels in a single pass over its code points.
+ * Lines break at spaces, before and after CJK ideographs/kana/hangul (but not
+ * before closing punctuation), and at '\n'; a word wider than a line is split
+ * between code points. Up to max_spans spans are written to `spans`; the
+ * return value is the total number of lines, which may be larger.
+ */
+int textwrap(GlyphCache *gc, const char *text, int max_width, TextSpan *spans, int max_spans);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEXTWRAP_H */
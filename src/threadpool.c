@@ -0,0 +1,123 @@
+/* threadpool.c - fixed set of worker threads running parallel-for jobs */
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "threadpool.h"
+
+typedef struct {
+    ThreadPool *pool;
+    int worker;
+} WorkerArg;
+
+struct ThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t work;        /* a job was posted or shutdown requested */
+    pthread_cond_t done;        /* the last task of a job finished */
+    pthread_t *threads;
+    WorkerArg *args;
+    int nthreads;               /* background threads (size - 1) */
+    /* current job */
+    ThreadTaskFn fn;
+    void *ctx;
+    int count, next, remaining;
+    unsigned generation;        /* bumped per job so workers see new work */
+    int shutdown;
+};
+
+/* claim and run tasks of the current job until none are left */
+static void drain(ThreadPool *p, int worker) {
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        if (p->next >= p->count) { pthread_mutex_unlock(&p->lock); return; }
+        int i = p->next++;
+        ThreadTaskFn fn = p->fn;
+        void *ctx = p->ctx;
+        pthread_mutex_unlock(&p->lock);
+
+        fn(ctx, i, worker);
+
+        pthread_mutex_lock(&p->lock);
+        if (--p->remaining == 0) pthread_cond_signal(&p->done);
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+static void *worker_main(void *arg) {
+    WorkerArg *wa = arg;
+    ThreadPool *p = wa->pool;
+    unsigned seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        while (!p->shutdown && p->generation == seen) pthread_cond_wait(&p->work, &p->lock);
+        if (p->shutdown) { pthread_mutex_unlock(&p->lock); return NULL; }
+        seen = p->generation;
+        pthread_mutex_unlock(&p->lock);
+        drain(p, wa->worker);
+    }
+}
+
+ThreadPool *threadpool_create(int threads) {
+    if (threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (int)n : 1;
+    }
+    ThreadPool *p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+    p->threads = calloc(threads, sizeof(pthread_t));
+    p->args = calloc(threads, sizeof(WorkerArg));
+    if (!p->threads || !p->args) { free(p->threads); free(p->args); free(p); return NULL; }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->work, NULL);
+    pthread_cond_init(&p->done, NULL);
+    for (int i = 1; i < threads; ++i) {
+        p->args[p->nthreads].pool = p;
+        p->args[p->nthreads].worker = i;
+        if (pthread_create(&p->threads[p->nthreads], NULL, worker_main, &p->args[p->nthreads]) != 0) break;
+        p->nthreads++;
+    }
+    return p;
+}
+
+int threadpool_size(const ThreadPool *pool) {
+    return pool ? pool->nthreads + 1 : 1;
+}
+
+void threadpool_run(ThreadPool *pool, ThreadTaskFn fn, void *ctx, int count) {
+    if (count <= 0) return;
+    if (!pool || pool->nthreads == 0) {
+        for (int i = 0; i < count; ++i) fn(ctx, i, 0);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->next = 0;
+    pool->remaining = count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    drain(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->remaining > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pool->count = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadpool_destroy(ThreadPool *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->nthreads; ++i) pthread_join(pool->threads[i], NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->args);
+    free(pool);
+}
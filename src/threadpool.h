@@ -0,0 +1,33 @@
+/* threadpool.h - fixed set of worker threads running parallel-for jobs */
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ThreadPool ThreadPool;
+
+/* task `index` of a job; `worker` is 0..threads-1 (the calling thread
+ * counts as worker 0), for per-thread scratch */
+typedef void (*ThreadTaskFn)(void *ctx, int index, int worker);
+
+/* Pool of `threads` workers including the caller (<= 0: one per online CPU).
+ * Workers that fail to start are dropped, so the pool may end up with fewer
+ * threads (see threadpool_size), down to running everything on the caller.
+ * Returns NULL only if out of memory. */
+ThreadPool *threadpool_create(int threads);
+int threadpool_size(const ThreadPool *pool);
+
+/* Run fn(ctx, i, worker) for every i in [0, count) and wait for all of
+ * them. Tasks are handed out in index order but finish in any order.
+ * A NULL pool runs everything on the calling thread. Not reentrant. */
+void threadpool_run(ThreadPool *pool, ThreadTaskFn fn, void *ctx, int count);
+
+void threadpool_destroy(ThreadPool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THREADPOOL_H */
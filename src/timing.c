@@ -0,0 +1,11 @@
+/* timing.c - monotonic wall clock */
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+
+#include "timing.h"
+
+double timing_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
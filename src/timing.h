@@ -0,0 +1,16 @@
+/* timing.h - monotonic wall clock for profiling and benchmarks */
+#ifndef TIMING_H
+#define TIMING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* milliseconds from an arbitrary fixed origin (monotonic) */
+double timing_now_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMING_H */
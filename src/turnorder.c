@@ -0,0 +1,109 @@
+/* turnorder.c - charge-time (ATB) turn scheduler */
+#include <stdlib.h>
+
+#include "sprite.h"
+#include "turnorder.h"
+
+int turn_delay_ms(int speed) {
+    if (speed < 1) speed = 1;
+    return TURN_BASE_MS * TURN_REF_SPEED / speed;
+}
+
+static int earlier(const TurnEvent *a, const TurnEvent *b) {
+    if (a->time != b->time) return a->time < b->time;
+    /* sequence numbers wrap; compare by signed distance */
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static void sift_up(TurnEvent *h, int i) {
+    TurnEvent e = h[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!earlier(&e, &h[parent])) break;
+        h[i] = h[parent];
+        i = parent;
+    }
+    h[i] = e;
+}
+
+static void sift_down(TurnEvent *h, int n, int i) {
+    TurnEvent e = h[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && earlier(&h[child + 1], &h[child])) child++;
+        if (!earlier(&h[child], &e)) break;
+        h[i] = h[child];
+        i = child;
+    }
+    h[i] = e;
+}
+
+static int push(TurnQueue *q, UnitId unit, int kind, int data, int delay_ms) {
+    if (q->count == q->cap) {
+        int cap = q->cap ? q->cap * 2 : 64;
+        TurnEvent *h = realloc(q->heap, sizeof(TurnEvent) * cap);
+        if (!h) return -1;
+        q->heap = h;
+        q->cap = cap;
+    }
+    TurnEvent *e = &q->heap[q->count];
+    e->time = q->now + (delay_ms > 0 ? delay_ms : 0);
+    e->seq = q->next_seq++;
+    e->unit = unit;
+    e->kind = kind;
+    e->data = data;
+    sift_up(q->heap, q->count++);
+    return 0;
+}
+
+int turnq_schedule(TurnQueue *q, UnitId unit, int delay_ms) {
+    int i = unit_index(unit);
+    if (i < 0) return -1;
+    if (delay_ms < 0) delay_ms = turn_delay_ms(g_units.speed[i]);
+    return push(q, unit, TURN_ACT, 0, delay_ms);
+}
+
+int turnq_schedule_cast(TurnQueue *q, const Sprite *caster, const Skill *spell, float modifier, int data) {
+    if (!caster || !spell) return -1;
+    return push(q, caster->unit, TURN_CAST, data, calc_cast_time_ms(caster, spell, modifier));
+}
+
+static void remove_top(TurnQueue *q) {
+    q->heap[0] = q->heap[--q->count];
+    if (q->count > 0) sift_down(q->heap, q->count, 0);
+}
+
+/* discard events of destroyed units until a live one is on top */
+static void drop_stale(TurnQueue *q) {
+    while (q->count > 0 && !unit_valid(q->heap[0].unit)) remove_top(q);
+}
+
+int turnq_pop(TurnQueue *q, TurnEvent *out) {
+    drop_stale(q);
+    if (q->count == 0) return 0;
+    TurnEvent top = q->heap[0];
+    remove_top(q);
+    q->now = top.time;
+    if (out) *out = top;
+    return 1;
+}
+
+int64_t turnq_peek_time(TurnQueue *q) {
+    drop_stale(q);
+    return q->count > 0 ? q->heap[0].time : -1;
+}
+
+void turnq_clear(TurnQueue *q) {
+    q->count = 0;
+    q->next_seq = 0;
+    q->now = 0;
+}
+
+void turnq_free(TurnQueue *q) {
+    free(q->heap);
+    q->heap = NULL;
+    q->count = q->cap = 0;
+    q->next_seq = 0;
+    q->now = 0;
+}
@@ -0,0 +1,69 @@
+/* turnorder.h - charge-time (ATB) turn scheduler */
+#ifndef TURNORDER_H
+#define TURNORDER_H
+
+#include <stdint.h>
+
+#include "action.h"
+#include "units.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A unit of speed TURN_REF_SPEED acts every TURN_BASE_MS of battle time;
+ * the delay scales inversely with speed. */
+#define TURN_BASE_MS 1000
+#define TURN_REF_SPEED 5
+
+typedef enum {
+    TURN_ACT = 0,   /* the unit's next action */
+    TURN_CAST       /* a delayed spell resolves */
+} TurnEventKind;
+
+typedef struct {
+    int64_t time;       /* battle clock, ms */
+    uint32_t seq;       /* scheduling order; breaks ties so equal times stay FIFO */
+    UnitId unit;
+    int kind;           /* TurnEventKind */
+    int data;           /* caller's tag (e.g. a spell id) */
+} TurnEvent;
+
+/* Binary min-heap of pending events. A zero-initialized TurnQueue is empty
+ * at time 0. Events of destroyed units are dropped when they reach the top.
+ */
+typedef struct {
+    TurnEvent *heap;
+    int count, cap;
+    uint32_t next_seq;
+    int64_t now;        /* time of the last popped event */
+} TurnQueue;
+
+/* delay between two actions of a unit with `speed` (speed <= 0 counts as 1) */
+int turn_delay_ms(int speed);
+
+/* Schedule `unit` to act one delay from now, or `delay_ms` from now when
+ * delay_ms >= 0. Returns 0 on success, -1 if out of memory. O(log n). */
+int turnq_schedule(TurnQueue *q, UnitId unit, int delay_ms);
+
+/* Queue a TURN_CAST for `caster` resolving after calc_cast_time_ms(caster,
+ * spell, modifier); `data` comes back in the event. O(log n). */
+int turnq_schedule_cast(TurnQueue *q, const Sprite *caster, const Skill *spell, float modifier, int data);
+
+/* Pop the earliest event whose unit is still alive and advance the clock to
+ * it. Returns 0 when the queue is empty. O(log n) amortized. */
+int turnq_pop(TurnQueue *q, TurnEvent *out);
+
+/* Time of the event turnq_pop would return next, or -1 if none. Drops
+ * events of destroyed units from the top first, so peek-then-pop always
+ * agrees. O(log n) amortized. */
+int64_t turnq_peek_time(TurnQueue *q);
+
+void turnq_clear(TurnQueue *q);
+void turnq_free(TurnQueue *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TURNORDER_H */
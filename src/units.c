@@ -0,0 +1,144 @@
+/* units.c - unit manager: hot unit fields as structure-of-arrays */
+#include <stdlib.h>
+#include <string.h>
+
+#include "units.h"
+
+#define SLOT_MASK ((1u << UNIT_SLOT_BITS) - 1)
+#define MAX_SLOTS ((int)SLOT_MASK)
+
+UnitStore g_units = {0};
+
+/* slot table: handle slot -> dense index (or next free slot), plus generation */
+typedef struct {
+    int dense;      /* -1 when free */
+    int next_free;
+    uint32_t gen;
+} UnitSlot;
+
+static UnitSlot *s_slots = NULL;
+static int s_slot_count = 0, s_slot_cap = 0;
+static int s_free = -1;
+
+static int grow_field(int **field, int cap) {
+    int *p = realloc(*field, sizeof(int) * cap);
+    if (!p) return -1;
+    *field = p;
+    return 0;
+}
+
+static int grow_store(void) {
+    int cap = g_units.cap ? g_units.cap * 2 : 64;
+    int **fields[] = { &g_units.x, &g_units.y, &g_units.hp, &g_units.max_hp, &g_units.mp,
+                       &g_units.max_mp, &g_units.attack, &g_units.defense, &g_units.speed,
+                       &g_units.move, &g_units.level, &g_units.job, &g_units.faction };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+        if (grow_field(fields[i], cap) != 0) return -1;
+    void **owner = realloc(g_units.owner, sizeof(void *) * cap);
+    if (!owner) return -1;
+    g_units.owner = owner;
+    UnitId *id = realloc(g_units.id, sizeof(UnitId) * cap);
+    if (!id) return -1;
+    g_units.id = id;
+    g_units.cap = cap;
+    return 0;
+}
+
+static int alloc_slot(void) {
+    if (s_free >= 0) {
+        int s = s_free;
+        s_free = s_slots[s].next_free;
+        return s;
+    }
+    if (s_slot_count >= MAX_SLOTS) return -1;
+    if (s_slot_count == s_slot_cap) {
+        int cap = s_slot_cap ? s_slot_cap * 2 : 64;
+        UnitSlot *p = realloc(s_slots, sizeof(UnitSlot) * cap);
+        if (!p) return -1;
+        s_slots = p;
+        s_slot_cap = cap;
+    }
+    /* slot 0 with generation 0 would encode UNIT_NONE, so generations start at 1 */
+    s_slots[s_slot_count].gen = 1;
+    return s_slot_count++;
+}
+
+UnitId unit_create(void *owner) {
+    if (g_units.count == g_units.cap && grow_store() != 0) return UNIT_NONE;
+    int slot = alloc_slot();
+    if (slot < 0) return UNIT_NONE;
+    int i = g_units.count++;
+    UnitId id = (s_slots[slot].gen << UNIT_SLOT_BITS) | (uint32_t)slot;
+    s_slots[slot].dense = i;
+    g_units.x[i] = g_units.y[i] = 0;
+    g_units.hp[i] = g_units.max_hp[i] = 0;
+    g_units.mp[i] = g_units.max_mp[i] = 0;
+    g_units.attack[i] = g_units.defense[i] = 0;
+    g_units.speed[i] = g_units.move[i] = 0;
+    g_units.level[i] = 0;
+    g_units.job[i] = 0;
+    g_units.faction[i] = 0;
+    g_units.owner[i] = owner;
+    g_units.id[i] = id;
+    return id;
+}
+
+int unit_index(UnitId id) {
+    uint32_t slot = id & SLOT_MASK;
+    if ((int)slot >= s_slot_count) return -1;
+    const UnitSlot *s = &s_slots[slot];
+    if (s->dense < 0 || s->gen != (id >> UNIT_SLOT_BITS)) return -1;
+    return s->dense;
+}
+
+int unit_valid(UnitId id) {
+    return unit_index(id) >= 0;
+}
+
+void unit_destroy(UnitId id) {
+    int i = unit_index(id);
+    if (i < 0) return;
+    int last = --g_units.count;
+    if (i != last) {
+        /* keep the arrays dense: move the last unit into the hole */
+        g_units.x[i] = g_units.x[last];
+        g_units.y[i] = g_units.y[last];
+        g_units.hp[i] = g_units.hp[last];
+        g_units.max_hp[i] = g_units.max_hp[last];
+        g_units.mp[i] = g_units.mp[last];
+        g_units.max_mp[i] = g_units.max_mp[last];
+        g_units.attack[i] = g_units.attack[last];
+        g_units.defense[i] = g_units.defense[last];
+        g_units.speed[i] = g_units.speed[last];
+        g_units.move[i] = g_units.move[last];
+        g_units.level[i] = g_units.level[last];
+        g_units.job[i] = g_units.job[last];
+        g_units.faction[i] = g_units.faction[last];
+        g_units.owner[i] = g_units.owner[last];
+        g_units.id[i] = g_units.id[last];
+        s_slots[g_units.id[i] & SLOT_MASK].dense = i;
+    }
+    uint32_t slot = id & SLOT_MASK;
+    s_slots[slot].dense = -1;
+    /* wrap within the bits left above the slot index, skipping 0 */
+    s_slots[slot].gen = (s_slots[slot].gen + 1) & ((1u << (32 - UNIT_SLOT_BITS)) - 1);
+    if (s_slots[slot].gen == 0) s_slots[slot].gen = 1;
+    s_slots[slot].next_free = s_free;
+    s_free = (int)slot;
+}
+
+void units_clear(void) {
+    free(g_units.x); free(g_units.y);
+    free(g_units.hp); free(g_units.max_hp);
+    free(g_units.mp); free(g_units.max_mp);
+    free(g_units.attack); free(g_units.defense);
+    free(g_units.speed); free(g_units.move);
+    free(g_units.level); free(g_units.job);
+    free(g_units.faction);
+    free(g_units.owner); free(g_units.id);
+    memset(&g_units, 0, sizeof(g_units));
+    free(s_slots);
+    s_slots = NULL;
+    s_slot_count = s_slot_cap = 0;
+    s_free = -1;
+}
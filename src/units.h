@@ -0,0 +1,56 @@
+/* units.h - unit manager: hot unit fields as structure-of-arrays */
+#ifndef UNITS_H
+#define UNITS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stable handle: slot index in the low 24 bits, slot generation above it.
+ * A handle goes stale when its unit is destroyed; 0 is never valid.
+ */
+typedef uint32_t UnitId;
+#define UNIT_NONE 0u
+#define UNIT_SLOT_BITS 24
+
+/* Live units are packed into [0, count) of every array, so systems (AI,
+ * combat, rendering) iterate them linearly. Destroying a unit moves the last
+ * one into its place: dense indices are only valid until the next
+ * unit_destroy, handles stay valid for the unit's lifetime.
+ */
+typedef struct {
+    int count;
+    int cap;
+    /* hot fields, indexed by dense index */
+    int *x, *y;           /* map row, col */
+    int *hp, *max_hp;
+    int *mp, *max_mp;
+    int *attack, *defense;
+    int *speed, *move;
+    int *level;
+    int *job;             /* JobType */
+    int *faction;
+    void **owner;         /* cold data (the Sprite that owns the unit), may be NULL */
+    UnitId *id;           /* handle of each dense entry */
+} UnitStore;
+
+extern UnitStore g_units;
+
+/* New unit with zeroed fields; returns UNIT_NONE if out of memory */
+UnitId unit_create(void *owner);
+void unit_destroy(UnitId id);
+
+/* dense index of a live unit, or -1 for a stale/invalid handle */
+int unit_index(UnitId id);
+int unit_valid(UnitId id);
+
+/* Destroy all units and release the arrays */
+void units_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UNITS_H */
@@ -0,0 +1,82 @@
+/* world.c - terrain map storage and Perlin-based generation */
+#include <stdlib.h>
+#include <time.h>
+
+#include "config.h"
+#include "perlin.h"
+#include "region.h"
+#include "rng.h"
+#include "world.h"
+
+int g_map_rows = 0;
+int g_map_cols = 0;
+Terrain* g_terrain_map = NULL;
+
+// neighbor offsets for odd-q vertical layout (cols offset)
+int get_neighbors(int r, int c, int *out_r, int *out_c) {
+    const int even_d[6][2] = {{-1,-1},{-1,0},{-1,1},{0,1},{1,0},{0,-1}};
+    const int odd_d[6][2]  = {{0,-1},{-1,0},{0,1},{1,1},{1,0},{1,-1}};
+    int count = 0;
+    const int (*d)[2] = (c % 2 == 0) ? even_d : odd_d;
+    for (int i = 0; i < 6; ++i) {
+        int nr = r + d[i][0];
+        int nc = c + d[i][1];
+        if (nr >= 0 && nr < g_map_rows && nc >= 0 && nc < g_map_cols) {
+            out_r[count] = nr; out_c[count] = nc; count++;
+        }
+    }
+    return count;
+}
+
+unsigned int world_seed_from_config(void) {
+    unsigned int seed = config_get_seed();
+    if (seed == 0) seed = (unsigned)time(NULL);
+    rng_init_streams(seed);
+    /* initialize perlin with params from config */
+    PerlinParams pp;
+    config_get_perlin_params(&pp);
+    if (pp.seed == 0) pp.seed = seed;
+    perlin_init_with_params(&pp);
+    return seed;
+}
+
+Terrain world_classify(float elev, float m) {
+    if (elev < 0.35f) return TERRAIN_WATER;
+    if (elev > 0.85f) return TERRAIN_MOUNTAIN;
+    if (elev > 0.6f) {
+        /* higher ground: hills or forest depending on moisture */
+        return (m > 0.55f) ? TERRAIN_FOREST : TERRAIN_HILLS;
+    }
+    /* low/medium ground: desert/plains/forest by moisture */
+    if (m < 0.28f) return TERRAIN_DESERT;
+    if (m > 0.65f) return TERRAIN_FOREST;
+    return TERRAIN_PLAINS;
+}
+
+int world_generate(int rows, int cols) {
+    if (rows <= 0 || cols <= 0) return -1;
+    Terrain *map = (Terrain*)malloc(sizeof(Terrain) * rows * cols);
+    if (!map) return -1;
+    world_free();
+    g_terrain_map = map;
+    g_map_rows = rows;
+    g_map_cols = cols;
+
+    /* 初始化地形：使用分形 Perlin 噪声生成更真实的地形 */
+    for (int r = 0; r < g_map_rows; r++) {
+        for (int c = 0; c < g_map_cols; c++) {
+            float elev = perlin_elevation((float)c, (float)r);
+            float m = perlin_moisture((float)c, (float)r);
+            TERRAIN_AT(r,c) = world_classify(elev, m);
+        }
+    }
+    /* label connected land so unreachable path goals are rejected immediately */
+    region_build();
+    return 0;
+}
+
+void world_free(void) {
+    region_cleanup();
+    if (g_terrain_map) { free(g_terrain_map); g_terrain_map = NULL; }
+    g_map_rows = g_map_cols = 0;
+}
@@ -0,0 +1,40 @@
+/* world.h - terrain map storage and generation */
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "path.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* MAP size is provided by config at runtime */
+extern int g_map_rows;
+extern int g_map_cols;
+extern Terrain* g_terrain_map; /* flattened [row*cols + col] */
+#define TERRAIN_AT(r,c) (g_terrain_map[(r)*g_map_cols + (c)])
+
+/* neighbor cells of (r,c) in the odd-q vertical layout; returns count (<= 6) */
+int get_neighbors(int r, int c, int *out_r, int *out_c);
+
+/* Seed the RNG streams and Perlin noise from config; a zero config seed is
+ * replaced by a time-based one. Returns the master seed in use.
+ */
+unsigned int world_seed_from_config(void);
+
+/* classify a cell from elevation and moisture samples in [0,1] */
+Terrain world_classify(float elev, float moisture);
+
+/* (Re)allocate a rows x cols map, fill it from Perlin noise and label its
+ * connected regions. Perlin must be initialized. Returns 0 on success.
+ */
+int world_generate(int rows, int cols);
+
+/* Free the map and derived data */
+void world_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORLD_H */